@@ -109,6 +109,7 @@ public:
     }
     void initTableCount(const std::string& t) override {}
     void incTableCount(const std::string& t) override {}
+    void addTableCount(const std::string& t, size_t n) override {}
 };
 
 }// slave
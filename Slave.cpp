@@ -17,6 +17,7 @@
 #include <memory>
 #include <regex>
 #include <string>
+#include <thread>
 
 #include "Slave.h"
 #include "SlaveStats.h"
@@ -35,8 +36,6 @@
 #include <signal.h>
 #include <unistd.h>
 
-#define packet_end_data 1
-
 #define ER_NET_PACKET_TOO_LARGE 1153
 #define ER_MASTER_FATAL_ERROR_READING_BINLOG 1236
 #define BIN_LOG_HEADER_SIZE 4
@@ -166,6 +165,15 @@ void Slave::createDatabaseStructure_(table_order_t& tabs, RelayLogInfo& rli) con
 
 
 
+void Slave::loadTimeZone()
+{
+    try {
+        m_time_zone = TimeZone::load();
+    } catch (const std::exception& e) {
+        LOG_WARNING(log, "Can't load local timezone, localtime_r() will be used: " << e.what());
+    }
+}
+
 void Slave::createTable(RelayLogInfo& rli,
                         const std::string& db_name, const std::string& tbl_name,
                         const collate_map_t& collate_map, nanomysql::Connection& conn) const
@@ -197,7 +205,7 @@ void Slave::createTable(RelayLogInfo& rli,
         switch (m_field.type) {
          // case MYSQL_TYPE_DECIMAL:
             case MYSQL_TYPE_NEWDECIMAL:
-                field = PtrField(new Field_decimal(name, type, m_field.length, m_field.decimals, m_field.flags & UNSIGNED_FLAG));
+                field = PtrField(new Field_decimal(name, type, m_field.length, m_field.decimals, m_field.flags & UNSIGNED_FLAG, m_typed_decimal));
                 break;
 
             case MYSQL_TYPE_TINY:
@@ -240,22 +248,22 @@ void Slave::createTable(RelayLogInfo& rli,
 
             case MYSQL_TYPE_TIMESTAMP:
             case MYSQL_TYPE_TIMESTAMP2:
-                field = PtrField(new Field_timestamp(name, type, m_field.decimals, m_master_info.is_old_storage));
+                field = PtrField(new Field_timestamp(name, type, m_field.decimals, m_master_info.is_old_storage, m_typed_temporal, m_time_zone));
                 break;
 
             case MYSQL_TYPE_TIME:
             case MYSQL_TYPE_TIME2:
-                field = PtrField(new Field_time(name, type, m_field.decimals, m_master_info.is_old_storage));
+                field = PtrField(new Field_time(name, type, m_field.decimals, m_master_info.is_old_storage, m_typed_temporal));
                 break;
 
             case MYSQL_TYPE_DATETIME:
             case MYSQL_TYPE_DATETIME2:
-                field = PtrField(new Field_datetime(name, type, m_field.decimals, m_master_info.is_old_storage));
+                field = PtrField(new Field_datetime(name, type, m_field.decimals, m_master_info.is_old_storage, m_typed_temporal));
                 break;
 
             case MYSQL_TYPE_DATE:
             case MYSQL_TYPE_NEWDATE:
-                field = PtrField(new Field_date(name, type));
+                field = PtrField(new Field_date(name, type, m_typed_temporal));
                 break;
 
             case MYSQL_TYPE_YEAR:
@@ -301,6 +309,7 @@ void Slave::createTable(RelayLogInfo& rli,
 
     }
 
+    table->compile_decode_plan();
 
     rli.setTable(tbl_name, db_name, std::move(table));
 
@@ -345,6 +354,10 @@ struct raii_mysql_connector
             disconnect();
         }
 
+        const auto& sConnOptions = m_master_info.conn_options;
+        // Before mysql_init(), so that invalid options do not leave it behind
+        nanomysql::Connection::checkOptions(sConnOptions);
+
         std::lock_guard<std::mutex> l(mutex);
         thread_id = ::pthread_self();
 
@@ -354,7 +367,6 @@ struct raii_mysql_connector
         }
 
         bool was_error = reconnect;
-        const auto& sConnOptions = m_master_info.conn_options;
         nanomysql::Connection::setOptions(mysql, sConnOptions);
 
         using mysql_guard::mysql_safe_connect;
@@ -394,6 +406,45 @@ struct raii_mysql_connector
         mysql_close(mysql);
     }
 };
+
+// Runs decoder and dispatcher threads of the pipeline, stops them on exit
+struct raii_pipeline
+{
+    PipelineRing ring;
+    std::thread decoder;
+    std::thread dispatcher;
+
+    raii_pipeline(size_t size,
+                  const std::function<void (PipelineRing&)>& decode,
+                  const std::function<void (PipelineRing&)>& dispatch)
+        : ring(size)
+        , decoder(decode, std::ref(ring))
+        , dispatcher(dispatch, std::ref(ring))
+    {}
+
+    void push(PipelineSlot::Kind kind)
+    {
+        PipelineSlot& slot = ring.acquire(0);
+        slot.kind = kind;
+        ring.release(0);
+    }
+
+    // The rest is done by decoder and dispatcher threads
+    void push(const char* buf, unsigned long len)
+    {
+        PipelineSlot& slot = ring.acquire(0);
+        slot.kind = PipelineSlot::Event;
+        slot.packet.assign(buf, buf + len);
+        ring.release(0);
+    }
+
+    ~raii_pipeline()
+    {
+        push(PipelineSlot::Stop);
+        decoder.join();
+        dispatcher.join();
+    }
+};
 }// anonymous-namespace
 
 
@@ -403,6 +454,8 @@ void Slave::get_remote_binlog(const std::function<bool()>& _interruptFlag)
     // the default handler for this signal is ignore
     sigUnblock(SIGURG);
     int count_packet = 0;
+    // Traffic is given to event_stat every traffic_period packets
+    const int traffic_period = 256;
 
     generateSlaveId();
 
@@ -415,8 +468,31 @@ void Slave::get_remote_binlog(const std::function<bool()>& _interruptFlag)
 
     register_slave_on_master(&mysql);
 
+    std::unique_ptr<raii_pipeline> pipeline;
+    if (m_pipeline_size)
+        pipeline.reset(new raii_pipeline(m_pipeline_size,
+                                         [this] (PipelineRing& ring) { decode_loop(ring); },
+                                         [this] (PipelineRing& ring) { dispatch_loop(ring); }));
+
 connected:
+    if (pipeline) {
+        // Let the pipeline deliver all read events, so that ext_state has
+        // the position to restart from, and drop the unfinished transaction
+        pipeline->ring.drain();
+        pipeline->push(PipelineSlot::Reconnected);
+    }
+    else {
+        // Rows of unfinished transaction will be read again
+        m_trx_buffer.clear();
+    }
+    if (m_workers)
+        m_workers->drain();
+    // BEGIN of the unfinished transaction will be read again
+    m_raw_filter.reset();
+
     do_checksum_handshake(&mysql);
+    if (m_heartbeat_period_ms)
+        set_heartbeat_period(&mysql);
 
     // Get binlog position saved in ext_state before, or load it
     // from persistent storage. Get false if failed to get binlog position.
@@ -433,24 +509,43 @@ connected:
     LOG_INFO(log, "Starting from binlog_pos: " << m_master_info.position);
 
     request_dump(m_master_info.position, &mysql);
+    MysqlEventSource source(&mysql);
     gtid_t gtid_next;
 
+    const auto deliver = [&] (const char* data, unsigned long size)
+    {
+        if (pipeline)
+            pipeline->push(data, size);
+        else
+            handle_event(data, size, gtid_next);
+    };
+
     while (!_interruptFlag()) {
 
         try {
 
             LOG_TRACE(log, "-- reading event --");
 
-            unsigned long len = read_event(&mysql);
+            ext_state.setStateProcessing(false);
+
+            const char* buf;
+            unsigned long len = 0;
+            const bool got_event = source.next(buf, len);
 
             ext_state.setStateProcessing(true);
 
             count_packet++;
             LOG_TRACE(log, "Got event with length: " << len << " Packet number: " << count_packet );
 
-            // end of data
+            if (event_stat && (!got_event || count_packet % traffic_period == 0)) {
+                uint64_t received_bytes, packet_bytes;
+                source.takeTraffic(received_bytes, packet_bytes);
+                event_stat->tickTraffic(received_bytes, packet_bytes);
+            }
+
+            // error or end of data
 
-            if (len == packet_error || len == packet_end_data) {
+            if (!got_event) {
 
                 uint mysql_error_number = mysql_errno(&mysql);
 
@@ -481,116 +576,400 @@ connected:
                 __conn.connect(true);
 
                 goto connected;
-            } // len == packet_error
+            } // !got_event
 
             // Ok event
 
-            if (len == packet_end_data) {
-                continue;
-            }
+            if (m_use_raw_filter)
+                m_raw_filter.feed(buf, len, event_stat, deliver);
+            else
+                deliver(buf, len);
 
-            slave::Basic_event_info event;
+        } catch (const std::exception& _ex ) {
 
-            if (!slave::read_log_event((const char*) mysql.net.read_pos + 1,
-                                       len - 1,
-                                       event,
-                                       event_stat,
-                                       masterGe56(),
-                                       m_master_info)) {
+            LOG_ERROR(log, "Met exception in get_remote_binlog cycle. Message: " << _ex.what() );
+            if (event_stat)
+                event_stat->tickError();
+            usleep(1000*1000);
+            continue;
 
-                LOG_TRACE(log, "Skipping unknown event.");
-                continue;
-            }
+        }
 
-            //
+    } //while
 
-            LOG_TRACE(log, "Event log position: " << event.log_pos );
+    LOG_WARNING(log, "Binlog monitor was stopped. Binlog events are not listened.");
 
-            if (event.log_pos != 0) {
-                m_master_info.position.log_pos = event.log_pos;
-                ext_state.setLastEventTimePos(event.when, event.log_pos);
-            }
+    deregister_slave_on_master(&mysql);
+}
 
-            LOG_TRACE(log, "seconds_behind_master: " << (::time(NULL) - event.when) );
+void Slave::read_events(EventSource& source, const std::function<bool()>& _interruptFlag)
+{
+    if (source.serverVersion()) {
+        m_master_version = source.serverVersion();
+        m_master_info.is_old_storage = m_master_version < 50604;
+    }
+    m_master_info.checksum_alg = BINLOG_CHECKSUM_ALG_OFF;
 
+    const Position pos = source.position();
+    if (!pos.empty()) {
+        m_master_info.position = pos;
+        ext_state.setMasterPosition(m_master_info.position);
+    }
 
-            // MySQL5.1.23 binlogs can be read only starting from a XID_EVENT
-            // MySQL5.1.23 ev->log_pos -- the binlog offset
+    LOG_INFO(log, "Reading events from binlog_pos: " << m_master_info.position);
 
-            if (event.type == XID_EVENT) {
+    m_trx_buffer.clear();
 
-                if (!gtid_next.first.empty())
-                    m_master_info.position.addGtid(gtid_next);
-                ext_state.setMasterPosition(m_master_info.position);
+    std::unique_ptr<raii_pipeline> pipeline;
+    if (m_pipeline_size)
+        pipeline.reset(new raii_pipeline(m_pipeline_size,
+                                         [this] (PipelineRing& ring) { decode_loop(ring); },
+                                         [this] (PipelineRing& ring) { dispatch_loop(ring); }));
 
-                LOG_TRACE(log, "Got XID event. Using binlog pos: " << m_master_info.position);
+    gtid_t gtid_next;
+    const char* buf;
+    unsigned long len;
 
-                if (m_xid_callback)
-                    m_xid_callback(event.server_id);
+    const auto deliver = [&] (const char* data, unsigned long size)
+    {
+        if (pipeline)
+            pipeline->push(data, size);
+        else
+            handle_event(data, size, gtid_next);
+    };
+    m_raw_filter.reset();
 
-            } else  if (event.type == ROTATE_EVENT) {
+    while (!_interruptFlag() && source.next(buf, len)) {
 
-                slave::Rotate_event_info rei(event.buf, event.event_len);
+        try {
 
-                /*
-                 * new_log_ident - new binlog name
-                 * pos - position of the starting event
-                 */
+            if (m_use_raw_filter)
+                m_raw_filter.feed(buf, len, event_stat, deliver);
+            else
+                deliver(buf, len);
 
-                LOG_INFO(log, "Got rotate event.");
+        } catch (const std::exception& _ex ) {
 
-                /* WTF
-                 */
+            LOG_ERROR(log, "Met exception in read_events cycle. Message: " << _ex.what() );
+            if (event_stat)
+                event_stat->tickError();
 
-                if (event.when == 0) {
+        }
+    }
 
-                    //LOG_TRACE(log, "ROTATE_FAKE");
-                }
+    // Deliver everything read before returning
+    pipeline.reset();
+    if (m_workers)
+        m_workers->drain();
 
-                m_master_info.position.log_name = rei.new_log_ident;
-                m_master_info.position.log_pos = rei.pos; // this will always be equal to 4
+    LOG_INFO(log, "Events are read up to binlog_pos: " << m_master_info.position);
+}
 
-                ext_state.setMasterPosition(m_master_info.position);
+void Slave::handle_event(const char* buf, unsigned long len, gtid_t& gtid_next, bool with_checksum)
+{
+    slave::Basic_event_info event;
+
+    if (!slave::read_log_event(buf,
+                               len,
+                               event,
+                               event_stat,
+                               masterGe56(),
+                               m_master_info,
+                               with_checksum)) {
+
+        LOG_TRACE(log, "Skipping unknown event.");
+        return;
+    }
 
-                LOG_TRACE(log, "new position is " << m_master_info.position);
-                LOG_TRACE(log, "ROTATE_EVENT processed OK.");
-            }
-            else if (event.type == GTID_LOG_EVENT)
-            {
-                LOG_TRACE(log, "Got GTID event.");
-                if (!gtid_next.first.empty())
-                {
-                    m_master_info.position.addGtid(gtid_next);
-                    ext_state.setMasterPosition(m_master_info.position);
-                }
-                Gtid_event_info gei(event.buf, event.event_len);
-                LOG_TRACE(log, "GTID_NEXT: sid = " << gei.m_sid << ", gno =  " << gei.m_gno);
-                gtid_next.first = gei.m_sid;
-                gtid_next.second = gei.m_gno;
-            }
+    if (event.type == HEARTBEAT_LOG_EVENT) {
+        handle_heartbeat(event);
+        return;
+    }
 
-            else if (process_event(event, m_rli))
-            {
-                LOG_TRACE(log, "Error in processing event.");
-            }
+    if (event.type == TRANSACTION_PAYLOAD_EVENT) {
+        if (!with_checksum)
+            throw std::runtime_error("Slave::handle_event(): TRANSACTION_PAYLOAD_EVENT inside of transaction payload");
+        handle_payload(event, gtid_next);
+        return;
+    }
 
+    LOG_TRACE(log, "Event log position: " << event.log_pos );
+
+    // In transaction mode BEGIN and COMMIT queries delimit transactions
+    // (COMMIT is used instead of XID for non-transactional tables).
+    bool is_commit_query = false;
+    if (m_transaction_callback && event.type == QUERY_EVENT) {
+        slave::Query_event_info qei(event.buf, event.event_len);
+        if (qei.query == "BEGIN")
+            m_trx_buffer.begin();
+        else if (qei.query == "COMMIT")
+            is_commit_query = true;
+    }
 
+    if (event.log_pos != 0) {
+        m_master_info.position.log_pos = event.log_pos;
+        if (!m_trx_buffer.started())
+            notifyLastEventTimePos(event);
+    }
 
-        } catch (const std::exception& _ex ) {
+    LOG_TRACE(log, "seconds_behind_master: " << (::time(NULL) - event.when) );
 
-            LOG_ERROR(log, "Met exception in get_remote_binlog cycle. Message: " << _ex.what() );
-            if (event_stat)
-                event_stat->tickError();
-            usleep(1000*1000);
-            continue;
 
+    // MySQL5.1.23 binlogs can be read only starting from a XID_EVENT
+    // MySQL5.1.23 ev->log_pos -- the binlog offset
+
+    if (event.type == XID_EVENT || is_commit_query) {
+
+        if (!gtid_next.first.empty())
+            m_master_info.position.addGtid(gtid_next);
+        if (m_trx_buffer.started())
+            commitTransaction(event, gtid_next);
+        notifyMasterPosition();
+
+        LOG_TRACE(log, "Got XID event. Using binlog pos: " << m_master_info.position);
+
+        if (m_xid_callback && event.type == XID_EVENT)
+            notifyXid(event);
+
+    } else  if (event.type == ROTATE_EVENT) {
+
+        slave::Rotate_event_info rei(event.buf, event.event_len);
+
+        /*
+         * new_log_ident - new binlog name
+         * pos - position of the starting event
+         */
+
+        LOG_INFO(log, "Got rotate event.");
+
+        /* WTF
+         */
+
+        if (event.when == 0) {
+
+            //LOG_TRACE(log, "ROTATE_FAKE");
         }
 
-    } //while
+        m_master_info.position.log_name = rei.new_log_ident;
+        m_master_info.position.log_pos = rei.pos; // this will always be equal to 4
 
-    LOG_WARNING(log, "Binlog monitor was stopped. Binlog events are not listened.");
+        notifyMasterPosition();
 
-    deregister_slave_on_master(&mysql);
+        LOG_TRACE(log, "new position is " << m_master_info.position);
+        LOG_TRACE(log, "ROTATE_EVENT processed OK.");
+    }
+    else if (event.type == GTID_LOG_EVENT)
+    {
+        LOG_TRACE(log, "Got GTID event.");
+        if (!gtid_next.first.empty())
+        {
+            m_master_info.position.addGtid(gtid_next);
+            notifyMasterPosition();
+        }
+        Gtid_event_info gei(event.buf, event.event_len);
+        LOG_TRACE(log, "GTID_NEXT: sid = " << gei.m_sid << ", gno =  " << gei.m_gno);
+        gtid_next.first = gei.m_sid;
+        gtid_next.second = gei.m_gno;
+    }
+
+    else if (process_event(event, m_rli))
+    {
+        LOG_TRACE(log, "Error in processing event.");
+    }
+}
+
+void Slave::handle_payload(const Basic_event_info& bei, gtid_t& gtid_next)
+{
+    const slave::Transaction_payload_event_info tpi(bei.buf, bei.event_len);
+    LOG_TRACE(log, "Got TRANSACTION_PAYLOAD_EVENT: compression " << tpi.m_compression << ", "
+              << tpi.m_payload_size << " bytes, " << tpi.m_uncompressed_size << " uncompressed");
+
+    const auto handle = [this, &gtid_next] (const char* buf, unsigned long len)
+    {
+        handle_event(buf, len, gtid_next, false);
+    };
+
+    // The payload is one whole transaction
+    m_payload_filter.reset();
+
+    // Rows of the pipeline are dispatched later and may refer to the events, so the slot keeps them
+    PipelineSlot* slot = m_pipeline_sink.slot;
+    m_payload_reader.unpack(tpi, [&] (char* buf, unsigned long len)
+    {
+        // Events inside of the payload are not positioned in the binlog, the end of the payload
+        // is the only position to restart from
+        int4store(buf + LOG_POS_OFFSET, bei.log_pos);
+
+        if (m_use_raw_filter)
+            m_payload_filter.feed(buf, len, event_stat, handle);
+        else
+            handle(buf, len);
+    }, slot ? &slot->payload : nullptr);
+}
+
+void Slave::handle_heartbeat(const Basic_event_info& bei)
+{
+    // The event carries the name of the binlog and the position of the last event
+    // the master has read from it, not of the event itself
+    const std::string log_name(bei.buf + LOG_EVENT_HEADER_LEN, bei.event_len - LOG_EVENT_HEADER_LEN);
+    LOG_TRACE(log, "Got heartbeat event: " << log_name << ":" << bei.log_pos);
+
+    if (m_trx_buffer.started() || log_name != m_master_info.position.log_name ||
+        bei.log_pos <= m_master_info.position.log_pos)
+        return;
+
+    m_master_info.position.log_pos = bei.log_pos;
+    notifyMasterPosition();
+}
+
+// Side effects of events go through these functions: in pipelined mode
+// they are deferred to the dispatcher thread, to keep order with row callbacks.
+
+void Slave::notifyLastEventTimePos(const Basic_event_info& bei)
+{
+    PipelineSlot* slot = m_pipeline_sink.slot;
+    if (!slot) {
+        applyLastEventTimePos(bei.when, bei.log_pos);
+        return;
+    }
+    slot->when = bei.when;
+    slot->log_pos = bei.log_pos;
+    slot->actions.emplace_back([this, slot] { applyLastEventTimePos(slot->when, slot->log_pos); });
+}
+
+void Slave::notifyMasterPosition()
+{
+    PipelineSlot* slot = m_pipeline_sink.slot;
+    if (!slot) {
+        applyMasterPosition(m_master_info.position);
+        return;
+    }
+    slot->position = m_master_info.position;
+    slot->actions.emplace_back([this, slot] { applyMasterPosition(slot->position); });
+}
+
+void Slave::notifyXid(const Basic_event_info& bei)
+{
+    PipelineSlot* slot = m_pipeline_sink.slot;
+    if (!slot) {
+        applyXid(bei.server_id);
+        return;
+    }
+    slot->server_id = bei.server_id;
+    slot->actions.emplace_back([this, slot] { applyXid(slot->server_id); });
+}
+
+// And with workers they wait for all rows before them to be applied.
+
+void Slave::applyLastEventTimePos(time_t when, unsigned long pos)
+{
+    // Position inside of a transaction is not safe to restart from, rows before it may be not applied yet
+    if (!m_workers || m_transaction_callback)
+        ext_state.setLastEventTimePos(when, pos);
+}
+
+void Slave::applyMasterPosition(const Position& pos)
+{
+    if (!m_workers || m_transaction_callback) {
+        ext_state.setMasterPosition(pos);
+        return;
+    }
+    CommitMarker& marker = m_workers->marker();
+    marker.position = pos;
+    marker.action = [this, &marker] { ext_state.setMasterPosition(marker.position); };
+    m_workers->barrier(marker);
+}
+
+void Slave::applyXid(unsigned int server_id)
+{
+    if (!m_workers || m_transaction_callback) {
+        m_xid_callback(server_id);
+        return;
+    }
+    CommitMarker& marker = m_workers->marker();
+    marker.server_id = server_id;
+    marker.action = [this, &marker] { m_xid_callback(marker.server_id); };
+    m_workers->barrier(marker);
+}
+
+void Slave::commitTransaction(const Basic_event_info& bei, const gtid_t& gtid)
+{
+    m_trx_buffer.finish();
+
+    Transaction& trx = m_trx_buffer.transaction();
+    if (trx.rows.empty())
+        return;
+
+    trx.gtid = gtid;
+    trx.when = bei.when;
+    trx.position = m_master_info.position;
+    trx.master_id = bei.server_id;
+
+    PipelineSlot* slot = m_pipeline_sink.slot;
+    if (!slot) {
+        m_transaction_callback(trx);
+        return;
+    }
+    // Buffer gets the transaction of the previous lap of the slot, which is already dispatched
+    std::swap(slot->transaction, trx);
+    slot->actions.emplace_back([this, slot] { m_transaction_callback(slot->transaction); });
+}
+
+void Slave::decode_loop(PipelineRing& ring)
+{
+    m_pipeline_ring = &ring;
+    gtid_t gtid_next;
+
+    while (true) {
+        PipelineSlot& slot = ring.acquire(1);
+        slot.reset();
+
+        if (slot.kind == PipelineSlot::Stop) {
+            m_pipeline_ring = nullptr;
+            ring.release(1);
+            return;
+        }
+
+        if (slot.kind == PipelineSlot::Reconnected) {
+            gtid_next = gtid_t();
+            m_trx_buffer.clear();
+        }
+        else {
+            m_pipeline_sink.slot = &slot;
+            try {
+                handle_event(slot.packet.data(), slot.packet.size(), gtid_next);
+            }
+            catch (const std::exception& _ex) {
+                LOG_ERROR(log, "Met exception in pipeline decoder. Message: " << _ex.what() );
+                if (event_stat)
+                    event_stat->tickError();
+            }
+            m_pipeline_sink.slot = nullptr;
+        }
+
+        ring.release(1);
+    }
+}
+
+void Slave::dispatch_loop(PipelineRing& ring)
+{
+    while (true) {
+        PipelineSlot& slot = ring.acquire(2);
+
+        for (auto& action : slot.actions) {
+            try {
+                action();
+            }
+            catch (const std::exception& _ex) {
+                LOG_ERROR(log, "Met exception in pipeline dispatcher. Message: " << _ex.what() );
+            }
+        }
+
+        const bool stop = slot.kind == PipelineSlot::Stop;
+        ring.release(2);
+        if (stop)
+            return;
+    }
 }
 
 void Slave::register_slave_on_master(MYSQL* mysql)
@@ -755,6 +1134,21 @@ void Slave::do_checksum_handshake(MYSQL* mysql)
     LOG_TRACE(log, "Success doing checksum handshake");
 }
 
+void Slave::set_heartbeat_period(MYSQL* mysql)
+{
+    // The master takes the period in nanoseconds
+    const std::string query = "SET @master_heartbeat_period= " + std::to_string(uint64_t(m_heartbeat_period_ms) * 1000000);
+
+    if (mysql_real_query(mysql, query.data(), static_cast<ulong>(query.size())))
+    {
+        mysql_free_result(mysql_store_result(mysql));
+        throw std::runtime_error("Slave::set_heartbeat_period(MYSQL* mysql): query '" + query + "' failed");
+    }
+    mysql_free_result(mysql_store_result(mysql));
+
+    LOG_TRACE(log, "Heartbeat period is set to " << m_heartbeat_period_ms << " ms");
+}
+
 
 
 namespace
@@ -801,16 +1195,16 @@ int Slave::process_event(const slave::Basic_event_info& bei, RelayLogInfo& m_rli
             if (m_table_order.count(key) == 1)
             {
                 LOG_DEBUG(log, "Rebuilding database structure.");
+                // Dispatcher may still be using the old table
+                if (m_pipeline_ring)
+                    m_pipeline_ring->drain(1);
+                if (m_workers)
+                    m_workers->drain();
                 table_order_t order {key};
                 createDatabaseStructure_(order, m_rli);
                 auto it = m_rli.m_table_map.find(key);
                 if (it != m_rli.m_table_map.end())
-                {
-                    it->second->m_callback = m_callbacks[key];
-                    it->second->m_filter = m_filters[key];
-                    it->second->set_column_filter(m_column_filters[key]);
-                    it->second->row_type = m_row_types[key];
-                }
+                    setupTable(key, *it->second);
             }
         }
         break;
@@ -820,14 +1214,17 @@ int Slave::process_event(const slave::Basic_event_info& bei, RelayLogInfo& m_rli
     {
         LOG_TRACE(log, "Got TABLE_MAP_EVENT.");
 
-        slave::Table_map_event_info tmi(bei.buf, bei.event_len);
-
-        const auto table_key = std::make_pair(tmi.m_dbnam, tmi.m_tblnam);
-        if (m_table_order.find(table_key) == m_table_order.cend()) {
+        // Names are checked before the column types and metadata are parsed: most of the tables
+        // of a busy server are usually not replicated
+        table_map_names(bei.buf, bei.event_len, m_table_map_key);
+        if (m_table_order.find(m_table_map_key) == m_table_order.cend()) {
             LOG_TRACE(log, "Ignoring TABLE_MAP_EVENT for unreplicated table");
             break;
         }
 
+        slave::Table_map_event_info tmi(bei.buf, bei.event_len);
+        const auto& table_key = m_table_map_key;
+
         m_rli.setTableName(tmi.m_table_id, tmi.m_tblnam, tmi.m_dbnam);
 
         if (m_master_version >= 50604)
@@ -903,36 +1300,48 @@ int Slave::process_event(const slave::Basic_event_info& bei, RelayLogInfo& m_rli
 
     case WRITE_ROWS_EVENT_V1: {
         LOG_TRACE(log, "Got WRITE_ROWS_EVENT_V1");
+        if (skip_row_event(m_rli, bei, event_stat))
+            break;
         Row_event_info roi(bei.buf, bei.event_len, false, false);
         apply_row_event(m_rli, bei, roi, ext_state, event_stat);
     } break;
 
     case UPDATE_ROWS_EVENT_V1: {
         LOG_TRACE(log, "Got UPDATE_ROWS_EVENT_V1");
+        if (skip_row_event(m_rli, bei, event_stat))
+            break;
         Row_event_info roi(bei.buf, bei.event_len, true, false);
         apply_row_event(m_rli, bei, roi, ext_state, event_stat);
     } break;
 
     case DELETE_ROWS_EVENT_V1: {
         LOG_TRACE(log, "Got DELETE_ROWS_EVENT_V1");
+        if (skip_row_event(m_rli, bei, event_stat))
+            break;
         Row_event_info roi(bei.buf, bei.event_len, false, false);
         apply_row_event(m_rli, bei, roi, ext_state, event_stat);
     } break;
 
     case WRITE_ROWS_EVENT: {
         LOG_TRACE(log, "Got WRITE_ROWS_EVENT");
+        if (skip_row_event(m_rli, bei, event_stat))
+            break;
         Row_event_info roi(bei.buf, bei.event_len, false, true);
         apply_row_event(m_rli, bei, roi, ext_state, event_stat);
     } break;
 
     case UPDATE_ROWS_EVENT: {
         LOG_TRACE(log, "Got UPDATE_ROWS_EVENT");
+        if (skip_row_event(m_rli, bei, event_stat))
+            break;
         Row_event_info roi(bei.buf, bei.event_len, true, true);
         apply_row_event(m_rli, bei, roi, ext_state, event_stat);
     } break;
 
     case DELETE_ROWS_EVENT: {
         LOG_TRACE(log, "Got DELETE_ROWS_EVENT");
+        if (skip_row_event(m_rli, bei, event_stat))
+            break;
         Row_event_info roi(bei.buf, bei.event_len, false, true);
         apply_row_event(m_rli, bei, roi, ext_state, event_stat);
     } break;
@@ -1006,35 +1415,6 @@ void Slave::request_dump(const Position& pos, MYSQL* mysql)
     }
 }
 
-ulong Slave::read_event(MYSQL* mysql)
-{
-
-    ulong len;
-    ext_state.setStateProcessing(false);
-
-#if MYSQL_VERSION_ID < 50705
-    len = cli_safe_read(mysql);
-#else
-    len = cli_safe_read(mysql, nullptr);
-#endif
-
-    if (len == packet_error) {
-        LOG_ERROR(log, "Myslave: Error reading packet from server: " << mysql_error(mysql)
-                  << "; mysql_error: " << mysql_errno(mysql));
-
-        return packet_error;
-    }
-
-    // check for end-of-data
-    if (len < 8 && mysql->net.read_pos[0] == 254) {
-
-        LOG_ERROR(log, "read_event(): end of data\n");
-        return packet_end_data;
-    }
-
-    return len;
-}
-
 void Slave::generateSlaveId()
 {
 
@@ -29,14 +29,22 @@
 #include <set>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 
 #include <pthread.h>
 
 #include <mysql.h>
 
+#include "binlog_file.h"
 #include "binlog_pos.h"
+#include "event_filter.h"
+#include "event_source.h"
 #include "slave_log_event.h"
 #include "SlaveStats.h"
+#include "pipeline.h"
+#include "transaction.h"
+#include "transaction_payload.h"
+#include "workers.h"
 
 
 namespace slave
@@ -49,12 +57,14 @@ public:
 
     typedef std::set<std::pair<std::string, std::string>> table_order_t;
     typedef std::map<std::pair<std::string, std::string>, callback> callbacks_t;
+    typedef std::map<std::pair<std::string, std::string>, batch_callback> batch_callbacks_t;
     typedef std::map<std::pair<std::string, std::string>, filter> filters_t;
     typedef std::map<std::pair<std::string, std::string>, ddl_callback> ddl_callbacks_t;
 
     typedef std::vector<std::string> cols_t;
     typedef std::map<std::pair<std::string, std::string>, cols_t> column_filters_t;
     typedef std::map<std::pair<std::string, std::string>, RowType> row_types_t;
+    typedef std::map<std::pair<std::string, std::string>, std::vector<unsigned>> key_columns_t;
 
 private:
     static inline bool falseFunction() { return false; };
@@ -64,6 +74,11 @@ private:
     int m_server_id;
     int m_master_version = 0;
     bool m_gtid_enabled = false;
+    bool m_typed_temporal = false;
+    bool m_typed_decimal = false;
+    bool m_reuse_record_sets = false;
+    bool m_zero_copy_strings = false;
+    std::shared_ptr<const TimeZone> m_time_zone;
 
     MasterInfo m_master_info;
     EmptyExtState empty_ext_state;
@@ -72,21 +87,95 @@ private:
 
     table_order_t m_table_order;
     callbacks_t m_callbacks;
+    batch_callbacks_t m_batch_callbacks;
     ddl_callbacks_t m_ddl_callbacks;
     filters_t m_filters;
     column_filters_t m_column_filters;
     row_types_t m_row_types;
+    key_columns_t m_key_columns;
 
     typedef std::function<void (unsigned int)> xid_callback_t;
     xid_callback_t m_xid_callback;
 
+    transaction_callback m_transaction_callback;
+    TransactionBuffer m_trx_buffer;
+
+    bool m_use_raw_filter = false;
+    RawEventFilter m_raw_filter{m_table_order};
+    // Events of transaction payloads are unpacked and filtered by the decoder
+    PayloadReader m_payload_reader;
+    RawEventFilter m_payload_filter{m_table_order};
+    unsigned int m_heartbeat_period_ms = 0;
+
+    size_t m_pipeline_size = 0;
+    PipelineSink m_pipeline_sink;
+    PipelineRing* m_pipeline_ring = nullptr;
+
     RelayLogInfo m_rli;
 
+    // Names of the last TABLE_MAP event, kept to not allocate them for every event
+    std::pair<std::string, std::string> m_table_map_key;
+
     pthread_t m_slave_thread_id = 0;
     std::mutex m_slave_thread_mutex;
 
+    // Goes after m_rli: workers are stopped before tables are destroyed
+    std::unique_ptr<WorkerPool> m_workers;
+
     void createDatabaseStructure_(table_order_t& tabs, RelayLogInfo& rli) const;
 
+    // Loads the zone of localtime_r(), warns if it can not be done
+    void loadTimeZone();
+
+    // Applies callbacks and options, set for the table, to its freshly built structure.
+    void setupTable(const std::pair<std::string, std::string>& key, Table& table)
+    {
+        table.m_callback = m_callbacks[key];
+        table.m_batch_callback = m_batch_callbacks[key];
+        table.m_filter = m_filters[key];
+        table.set_column_filter(m_column_filters[key]);
+        table.row_type = m_row_types[key];
+        table.reuse_record_sets = m_reuse_record_sets;
+        table.zero_copy_strings = m_zero_copy_strings;
+        if (m_pipeline_size)
+            table.m_sink = &m_pipeline_sink;
+        else
+            table.m_sink = m_workers.get();
+        m_pipeline_sink.next = m_workers.get();
+
+        if (m_transaction_callback) {
+            // Views point into the event buffer, which does not live until commit
+            if (table.row_type == RowType::View)
+                throw std::runtime_error("Slave::setupTable(): RowType::View can not be used with transaction callback, table " + table.full_name);
+            if (table.zero_copy_strings)
+                throw std::runtime_error("Slave::setupTable(): zero-copy strings can not be used with transaction callback, table " + table.full_name);
+            table.m_sink = &m_trx_buffer;
+        }
+        else if (m_workers) {
+            if (table.row_type == RowType::View)
+                throw std::runtime_error("Slave::setupTable(): RowType::View can not be used with workers, table " + table.full_name);
+            if (table.zero_copy_strings)
+                throw std::runtime_error("Slave::setupTable(): zero-copy strings can not be used with workers, table " + table.full_name);
+            // Spread tables over workers evenly, in the same way after rebuild
+            table.m_worker = std::distance(m_table_order.begin(), m_table_order.find(key));
+            table.set_key_columns(m_key_columns[key]);
+        }
+    }
+
+    void handle_event(const char* buf, unsigned long len, gtid_t& gtid_next, bool with_checksum = true);
+    void handle_payload(const Basic_event_info& bei, gtid_t& gtid_next);
+    void handle_heartbeat(const Basic_event_info& bei);
+    void decode_loop(PipelineRing& ring);
+    void dispatch_loop(PipelineRing& ring);
+
+    void notifyLastEventTimePos(const Basic_event_info& bei);
+    void notifyMasterPosition();
+    void notifyXid(const Basic_event_info& bei);
+    void applyLastEventTimePos(time_t when, unsigned long pos);
+    void applyMasterPosition(const Position& pos);
+    void applyXid(unsigned int server_id);
+    void commitTransaction(const Basic_event_info& bei, const gtid_t& gtid);
+
 public:
 
     Slave() : ext_state(empty_ext_state) {}
@@ -123,6 +212,7 @@ public:
         const std::pair<std::string, std::string> key = std::make_pair(_db_name, _tbl_name);
         m_table_order.insert(key);
         m_callbacks[key] = _callback;
+        m_batch_callbacks.erase(key);
         m_filters[key] = filter;
         m_column_filters[key] = cols_t();
         m_row_types[key] = row_type;
@@ -130,6 +220,22 @@ public:
         ext_state.initTableCount(_db_name + "." + _tbl_name);
     }
 
+    // Batch callback gets all rows of one WRITE/UPDATE/DELETE_ROWS event at once.
+    // Replaces row callback of the table, if any, and vice versa.
+    void setBatchCallback(const std::string& _db_name, const std::string& _tbl_name, batch_callback _callback,
+                          const cols_t& column_filter, RowType row_type = RowType::Map, EventKind filter = eAll)
+    {
+        setBatchCallback(_db_name, _tbl_name, _callback, row_type, filter);
+        m_column_filters[std::make_pair(_db_name, _tbl_name)] = column_filter;
+    }
+
+    void setBatchCallback(const std::string& _db_name, const std::string& _tbl_name, batch_callback _callback,
+                          RowType row_type = RowType::Map, EventKind filter = eAll)
+    {
+        setCallback(_db_name, _tbl_name, callback(), row_type, filter);
+        m_batch_callbacks[std::make_pair(_db_name, _tbl_name)] = _callback;
+    }
+
     void setDDLCallback(const std::string& _db_name, const std::string& _tbl_name, ddl_callback _callback)
     {
         const auto key = std::make_pair(_db_name, _tbl_name);
@@ -141,20 +247,134 @@ public:
         m_xid_callback = _callback;
     }
 
+    // Transaction mode: rows of subscribed tables are collected from BEGIN up to XID (or COMMIT)
+    // and handed to this callback at once, table callbacks are not called (they may be empty).
+    // Master position is not advanced inside of a transaction, so after reconnect
+    // the interrupted transaction is read again from its beginning.
+    // Must be set before createDatabaseStructure().
+    void setTransactionCallback(transaction_callback _callback)
+    {
+        m_transaction_callback = _callback;
+    }
+
+    // Pipelined mode: reading from network, decoding events and calling callbacks
+    // are done by three threads, connected with a ring of ring_size events (0 turns it off).
+    // Callbacks are called in order, but from the dispatcher thread.
+    // Every slot of the ring keeps memory for the largest event it has got.
+    // Must be set before createDatabaseStructure().
+    void enablePipeline(size_t ring_size = 256)
+    {
+        m_pipeline_size = ring_size;
+    }
+
+    // Table callbacks are called by a pool of workers threads, each table by its own worker,
+    // so rows of a table are in order. Master position is advanced (and xid callback is called)
+    // only after all workers have applied the rows before it, and only on commits.
+    // Is not used in transaction mode. Must be set before createDatabaseStructure().
+    void enableWorkers(size_t workers, size_t queue_size = 1024)
+    {
+        m_workers.reset(workers ? new WorkerPool(workers, queue_size) : nullptr);
+    }
+
+    // Rows of the table are spread over workers by hash of the given columns (i.e. primary key),
+    // instead of sending the whole table to one worker. Order is kept for rows with the same key.
+    // Update, which changes the key, waits for all workers to apply the rows before it.
+    // Rows, whose image lacks some of the columns (binlog_row_image=MINIMAL and the columns are
+    // not the primary key), are applied alone: after all rows before them and before all after.
+    // Columns are indexes in the table, as in RecordSet. Must be set before createDatabaseStructure().
+    void setKeyColumns(const std::string& _db_name, const std::string& _tbl_name, const std::vector<unsigned>& _columns)
+    {
+        m_key_columns[std::make_pair(_db_name, _tbl_name)] = _columns;
+    }
+
+    // Typed temporal mode: TIMESTAMP, DATETIME, DATE and TIME values are given to callbacks
+    // as Timestamp, DateTime, Date and Time (see temporal.h) instead of formatted strings,
+    // use their str() to get the string. Must be set before createDatabaseStructure().
+    void setTypedTemporal(bool on = true)
+    {
+        m_typed_temporal = on;
+    }
+
+    // Typed decimal mode: DECIMAL values are given to callbacks as Decimal (see slave_decimal.h),
+    // unscaled integer with precision and scale, instead of strings; use its str() or toDouble()
+    // to convert it. Columns with precision above 38 are still given as strings.
+    // Must be set before createDatabaseStructure().
+    void setTypedDecimal(bool on = true)
+    {
+        m_typed_decimal = on;
+    }
+
+    // Pooled RecordSet mode: callbacks of a table get the same RecordSet (batch callbacks - the same
+    // batch) for every row, cleared but with the capacity of its vectors and strings kept, so rows
+    // of RowType::Vector are decoded without allocations in steady state. Data, which is needed
+    // after the callback returns, must be moved (or copied) out of the RecordSet.
+    // Must be set before createDatabaseStructure().
+    void setReuseRecordSets(bool on = true)
+    {
+        m_reuse_record_sets = on;
+    }
+
+    // Zero-copy strings mode: values of CHAR, VARCHAR, TEXT and BLOB columns, which do not fit
+    // inline in FieldValue, refer to the binlog event buffer instead of being copied. They are
+    // valid until the callback returns; call FieldValue::materialize() or RecordSet::materialize()
+    // to keep them. Can not be used with transaction callback and workers.
+    // Must be set before createDatabaseStructure().
+    void setZeroCopyStrings(bool on = true)
+    {
+        m_zero_copy_strings = on;
+    }
+
+    // Raw event filter: TABLE_MAP and ROWS events of tables without callbacks, and BEGIN of
+    // transactions, which touch only such tables, are dropped as they are read, before checksum
+    // check and parsing, and are reported by EventStatIface::tickEventSkipped(). GTID, XID and
+    // other QUERY events are still processed, so the position and table structure are kept up.
+    // Must be set before get_remote_binlog() or read_events().
+    void setRawEventFilter(bool on = true)
+    {
+        m_use_raw_filter = on;
+    }
+
+    // Master sends heartbeat events after this period of silence (0, the default, turns them off).
+    // They keep the connection alive and advance the master position to the one they carry,
+    // when it is not inside of a transaction, so the position keeps up with the master, while
+    // its events are dropped (see setRawEventFilter()). Must be set before get_remote_binlog().
+    void setHeartbeatPeriod(unsigned int period_ms)
+    {
+        m_heartbeat_period_ms = period_ms;
+    }
+
+    // Timezone, in which TIMESTAMP values are formatted: zoneinfo name (i.e. "Europe/Moscow"),
+    // file path or POSIX TZ string. It is loaded once, and the conversion takes no lock, unlike
+    // localtime_r(). By default the zone of localtime_r() ($TZ or /etc/localtime) is loaded by
+    // createDatabaseStructure(); if it can not be loaded, localtime_r() is used.
+    // Throws if the zone can not be loaded. Must be set before createDatabaseStructure().
+    void setTimeZone(const std::string& name)
+    {
+        m_time_zone = TimeZone::load(name);
+    }
+
+    const std::shared_ptr<const TimeZone>& timeZone() const { return m_time_zone; }
+
     void get_remote_binlog(const std::function<bool()>& _interruptFlag = &Slave::falseFunction);
 
+    // Reads events from the given source (i.e. local binlog files, see BinlogFileSource, or memory)
+    // instead of the master, and passes them to the same callbacks. Stops when the source has no
+    // more events or when interrupt flag is set, does not reconnect. Master position is taken from
+    // the source, if it knows it. Table structure is still read from the server by
+    // createDatabaseStructure(), init() is not needed.
+    void read_events(EventSource& source, const std::function<bool()>& _interruptFlag = &Slave::falseFunction);
+
     void createDatabaseStructure() {
 
         m_rli.clear();
 
+        if (!m_time_zone)
+            loadTimeZone();
+
         createDatabaseStructure_(m_table_order, m_rli);
 
-        for (RelayLogInfo::name_to_table_t::iterator i = m_rli.m_table_map.begin(); i != m_rli.m_table_map.end(); ++i) {
-            i->second->m_callback = m_callbacks[i->first];
-            i->second->m_filter = m_filters[i->first];
-            i->second->set_column_filter(m_column_filters[i->first]);
-            i->second->row_type = m_row_types[i->first];
-        }
+        for (RelayLogInfo::name_to_table_t::iterator i = m_rli.m_table_map.begin(); i != m_rli.m_table_map.end(); ++i)
+            setupTable(i->first, *i->second);
     }
 
     const RelayLogInfo& getRli() const {
@@ -191,8 +411,6 @@ protected:
     void request_dump_wo_gtid(const std::string& logname, unsigned long start_position, MYSQL* mysql);
     void request_dump(const Position& pos, MYSQL* mysql);
 
-    ulong read_event(MYSQL* mysql);
-
     void createTable(RelayLogInfo& rli,
                      const std::string& db_name, const std::string& tbl_name,
                      const collate_map_t& collate_map, nanomysql::Connection& conn) const;
@@ -200,6 +418,7 @@ protected:
     void register_slave_on_master(MYSQL* mysql);
     void deregister_slave_on_master(MYSQL* mysql);
     void do_checksum_handshake(MYSQL* mysql);
+    void set_heartbeat_period(MYSQL* mysql);
 
     void generateSlaveId();
 
@@ -109,6 +109,10 @@ struct ExtStateIface {
     // so there is no function for getting this statistics.
     virtual void initTableCount(const std::string& t) = 0;
     virtual void incTableCount(const std::string& t) = 0;
+    // Adds n to the counter of the table at once: rows of a batch (see Slave::setBatchCallback())
+    // are counted by one call. The default makes n calls of incTableCount(), override it, if that
+    // locks or is expensive otherwise.
+    virtual void addTableCount(const std::string& t, size_t n) { while (n--) incTableCount(t); }
 
     virtual ~ExtStateIface() {}
 };
@@ -145,6 +149,7 @@ struct EmptyExtState: public ExtStateIface {
     bool getStateProcessing()                   override { return false; }
     void initTableCount(const std::string& t)   override {}
     void incTableCount(const std::string& t)    override {}
+    void addTableCount(const std::string& t, size_t n) override {}
 
 private:
     Position        position;
@@ -188,6 +193,9 @@ public:
     virtual void tickXid() {}
     // Unprocessed libslave events.
     virtual void tickOther() {}
+    // Events dropped by the raw event filter (see Slave::setRawEventFilter()) before checksum
+    // check and parsing, with their size in bytes. They are not counted by tick().
+    virtual void tickEventSkipped(unsigned long /*bytes*/) {}
     // UPDATE/INSERT/DELETE missed (there are not callbacks on given type of operation).
     virtual void tickModifyEventIgnored(const unsigned long /*id*/, EventKind /*kind*/) {}
     // UPDATE/INSERT/DELETE filtered (there are callbacks on other types of operations,
@@ -199,8 +207,21 @@ public:
     virtual void tickModifyEventFailed(const unsigned long /*id*/, EventKind /*kind*/) {}
     // UPDATE/INSERT/DELETE rows successfully processed (Modify event may affect several rows of table).
     virtual void tickModifyRowDone(const unsigned long /*id*/, EventKind /*kind*/, uint64_t /*callbackWorkTimeNanoSeconds*/) {}
+    // Rows of a batch (see Slave::setBatchCallback()) processed by one callback call, which took
+    // callbackWorkTimeNanoSeconds. The default makes a tickModifyRowDone() call per row with
+    // an equal share of the time.
+    virtual void tickModifyRowsDone(const unsigned long id, EventKind kind, size_t rows, uint64_t callbackWorkTimeNanoSeconds)
+    {
+        for (size_t i = 0; i < rows; ++i)
+            tickModifyRowDone(id, kind, callbackWorkTimeNanoSeconds / rows);
+    }
     // Errors during processing
     virtual void tickError() {}
+    // Traffic of the binlog dump connection since the previous call: bytes received from the socket,
+    // as they were sent, i.e. compressed (see mysql_conn_opts::mysql_compression), and bytes of
+    // the protocol packets after decompression. Called every few hundred packets and on reconnect.
+    // received_bytes is 0 where the socket does not tell it (not Linux).
+    virtual void tickTraffic(uint64_t /*received_bytes*/, uint64_t /*packet_bytes*/) {}
 };
 }
 
@@ -0,0 +1,84 @@
+#ifndef __SLAVE_BENCH_H_
+#define __SLAVE_BENCH_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Tiny benchmark harness: runs a case until it takes enough time, then prints rates.
+// Cases are selected by substrings of their names given in the command line.
+
+namespace bench
+{
+
+// Heap allocations made by the process, counted by replaced operator new (alloc_counter.cpp)
+extern std::atomic<uint64_t> allocations;
+
+// What one lap of a case has processed
+struct Counters
+{
+    uint64_t events = 0;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+};
+
+class Runner
+{
+public:
+    Runner(int argc, char** argv, double min_time = 0.5)
+        : m_filters(argv + 1, argv + argc)
+        , m_min_time(min_time)
+    {
+        ::printf("%-40s %14s %14s %12s %12s\n", "case", "events/s", "rows/s", "MB/s", "allocs/row");
+    }
+
+    void run(const std::string& name, const std::function<void (Counters&)>& lap)
+    {
+        if (!selected(name))
+            return;
+
+        // Warm up caches and reusable buffers
+        Counters total;
+        lap(total);
+
+        total = Counters();
+        const uint64_t allocs_start = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        double elapsed = 0;
+        do {
+            lap(total);
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < m_min_time);
+        const uint64_t allocs = allocations.load() - allocs_start;
+
+        ::printf("%-40s %14.0f %14.0f %12.1f %12.2f\n",
+                 name.c_str(),
+                 total.events / elapsed,
+                 total.rows / elapsed,
+                 total.bytes / elapsed / (1024 * 1024),
+                 total.rows ? double(allocs) / total.rows : 0.);
+        ::fflush(stdout);
+    }
+
+private:
+    bool selected(const std::string& name) const
+    {
+        if (m_filters.empty())
+            return true;
+        for (const auto& f : m_filters)
+            if (name.find(f) != std::string::npos)
+                return true;
+        return false;
+    }
+
+    std::vector<std::string> m_filters;
+    double m_min_time;
+};
+
+}// bench
+
+#endif
@@ -0,0 +1,45 @@
+// CRC32 of binlog events: every implementation supported by the CPU on buffers of typical
+// event sizes, from small row events to large blob ones.
+//
+// Usage: bench_crc [case name substring ...]
+
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+#include "crc32.h"
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+
+    static const size_t sizes[] = {64, 256, 1024, 8192, 65536, 1 << 20};
+    std::vector<unsigned char> data(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = i * 2654435761U >> 24;
+
+    // Implementations must agree before being compared
+    const auto& impls = slave::crc32_impls();
+    for (const auto& impl : impls)
+        if (impl.func(0, data.data(), data.size()) != impls.back().func(0, data.data(), data.size())) {
+            ::fprintf(stderr, "CRC32 implementation %s is broken\n", impl.name);
+            return 1;
+        }
+
+    for (const size_t size : sizes)
+        for (const auto& impl : impls)
+        {
+            volatile uint32_t sink = 0;
+            runner.run(std::string(impl.name) + "/" + std::to_string(size), [&](bench::Counters& c)
+            {
+                for (size_t offset = 0; offset + size <= data.size(); offset += size)
+                {
+                    sink = impl.func(sink, data.data() + offset, size);
+                    ++c.events;
+                    c.bytes += size;
+                }
+            });
+        }
+    return 0;
+}
@@ -0,0 +1,440 @@
+// Decoder throughput on synthetic corpora: narrow, wide, blob-heavy and decimal/datetime-heavy
+// tables, and every Field::unpack() specialization alone. No MySQL server is needed.
+//
+// Usage: bench_decoder [case name substring ...]
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "bench.h"
+#include "binlog_writer.h"
+
+#include "SlaveStats.h"
+#include "event_filter.h"
+#include "event_source.h"
+#include "field.h"
+#include "relayloginfo.h"
+#include "slave_log_event.h"
+#include "transaction_payload.h"
+
+namespace
+{
+
+struct Corpus
+{
+    std::string name;
+    slave::RelayLogInfo rli;
+    slave::Table* table = nullptr;
+    std::string binlog;
+};
+
+// Makes the table, known to the decoder, and the corpus of its ROWS events
+template <typename MakeFields, typename MakeRow>
+std::unique_ptr<Corpus> makeCorpus(const std::string& name, MakeFields make_fields, const std::vector<uint8_t>& types,
+                                   MakeRow make_row, unsigned transactions, unsigned rows_per_event)
+{
+    std::unique_ptr<Corpus> corpus(new Corpus);
+    corpus->name = name;
+
+    slave::PtrTable table(new slave::Table("bench", name));
+    make_fields(table->fields);
+    table->compile_decode_plan();
+    table->m_filter = slave::eAll;
+    table->row_type = slave::RowType::Map;
+    corpus->table = table.get();
+    corpus->rli.setTable(name, "bench", std::move(table));
+
+    const unsigned width = types.size();
+    bench::BinlogWriter writer(true);
+    unsigned n = 0;
+    for (unsigned t = 0; t < transactions; ++t)
+    {
+        writer.tableMap(100, "bench", name, types);
+
+        std::vector<std::string> rows;
+        for (unsigned r = 0; r < rows_per_event; ++r)
+            rows.push_back(make_row(width, n++));
+        writer.rows(slave::WRITE_ROWS_EVENT, 100, width, rows);
+
+        // Every other transaction updates the same rows
+        if (t % 2)
+        {
+            std::vector<std::string> images;
+            for (unsigned r = 0; r < rows_per_event; ++r)
+            {
+                images.push_back(make_row(width, n - rows_per_event + r));
+                images.push_back(make_row(width, n + r));
+            }
+            writer.rows(slave::UPDATE_ROWS_EVENT, 100, width, images);
+        }
+        writer.xid(t);
+    }
+    corpus->binlog = writer.data();
+    return corpus;
+}
+
+std::unique_ptr<Corpus> narrowCorpus()
+{
+    return makeCorpus("narrow",
+        [](std::vector<slave::PtrField>& fields)
+        {
+            fields.emplace_back(new slave::Field_num<int32>("id", "int(11)"));
+            fields.emplace_back(new slave::Field_num<int32>("value", "int(11)"));
+        },
+        {::MYSQL_TYPE_LONG, ::MYSQL_TYPE_LONG},
+        [](unsigned width, unsigned n)
+        {
+            return bench::RowPacker(width).integer(n, 4).integer(n * 7, 4).data();
+        },
+        2000, 20);
+}
+
+std::unique_ptr<Corpus> wideCorpus()
+{
+    static const unsigned columns = 64;
+    std::vector<uint8_t> types;
+    for (unsigned i = 0; i < columns; ++i)
+    {
+        static const uint8_t cycle[] = {::MYSQL_TYPE_LONG, ::MYSQL_TYPE_LONGLONG, ::MYSQL_TYPE_DOUBLE, ::MYSQL_TYPE_VARCHAR};
+        types.push_back(cycle[i % 4]);
+    }
+
+    return makeCorpus("wide",
+        [](std::vector<slave::PtrField>& fields)
+        {
+            for (unsigned i = 0; i < columns; ++i)
+            {
+                const std::string name = "c" + std::to_string(i);
+                switch (i % 4)
+                {
+                case 0: fields.emplace_back(new slave::Field_num<int32>(name, "int(11)")); break;
+                case 1: fields.emplace_back(new slave::Field_num<longlong>(name, "bigint(20)")); break;
+                case 2: fields.emplace_back(new slave::Field_num<double>(name, "double")); break;
+                case 3: fields.emplace_back(new slave::Field_string(name, "varchar(64)", 64)); break;
+                }
+            }
+        },
+        types,
+        [](unsigned width, unsigned n)
+        {
+            bench::RowPacker row(width);
+            for (unsigned i = 0; i < columns; ++i)
+            {
+                // Some columns are NULL
+                if ((n + i) % 13 == 0)
+                {
+                    row.null();
+                    continue;
+                }
+                switch (i % 4)
+                {
+                case 0: row.integer(n + i, 4); break;
+                case 1: row.integer((uint64_t(n) << 20) + i, 8); break;
+                case 2: row.real(n * 0.5 + i); break;
+                case 3: row.string("value " + std::to_string(n) + " of column " + std::to_string(i)); break;
+                }
+            }
+            return row.data();
+        },
+        500, 5);
+}
+
+std::unique_ptr<Corpus> blobCorpus()
+{
+    return makeCorpus("blob",
+        [](std::vector<slave::PtrField>& fields)
+        {
+            fields.emplace_back(new slave::Field_num<int32>("id", "int(11)"));
+            fields.emplace_back(new slave::Field_string("title", "varchar(200)", 200));
+            fields.emplace_back(new slave::Field_blob("body", "text", 65535));
+        },
+        {::MYSQL_TYPE_LONG, ::MYSQL_TYPE_VARCHAR, ::MYSQL_TYPE_BLOB},
+        [](unsigned width, unsigned n)
+        {
+            const std::string body(2048 + (n % 8) * 512, char('a' + n % 26));
+            return bench::RowPacker(width).integer(n, 4).string("title of document " + std::to_string(n)).string(body, 2).data();
+        },
+        500, 4);
+}
+
+std::unique_ptr<Corpus> temporalCorpus()
+{
+    return makeCorpus("decimal_datetime",
+        [](std::vector<slave::PtrField>& fields)
+        {
+            fields.emplace_back(new slave::Field_num<int32>("id", "int(11)"));
+            fields.emplace_back(new slave::Field_decimal("price", "decimal(10,2)", 12, 2, false));
+            fields.emplace_back(new slave::Field_decimal("amount", "decimal(20,6)", 22, 6, false));
+            fields.emplace_back(new slave::Field_datetime("created", "datetime(6)", 6, false));
+            fields.emplace_back(new slave::Field_timestamp("updated", "timestamp", 0, false));
+            fields.emplace_back(new slave::Field_date("day", "date"));
+            fields.emplace_back(new slave::Field_time("at", "time", 0, false));
+        },
+        {::MYSQL_TYPE_LONG, ::MYSQL_TYPE_NEWDECIMAL, ::MYSQL_TYPE_NEWDECIMAL,
+         slave::MYSQL_TYPE_DATETIME2, slave::MYSQL_TYPE_TIMESTAMP2, ::MYSQL_TYPE_NEWDATE, slave::MYSQL_TYPE_TIME2},
+        [](unsigned width, unsigned n)
+        {
+            return bench::RowPacker(width)
+                .integer(n, 4)
+                .decimal(n * 101 % 10000000, 10, 2)
+                .decimal(uint64_t(n) * 1000003, 20, 6)
+                .datetime(2020, 1 + n % 12, 1 + n % 28, n % 24, n % 60, n % 60, n % 1000000)
+                .timestamp(1500000000 + n)
+                .date(2020, 1 + n % 12, 1 + n % 28)
+                .time(n % 24, n % 60, n % 60)
+                .data();
+        },
+        1000, 20);
+}
+
+// Goes through the corpus as Slave does, decoding rows if asked
+void lap(Corpus& corpus, bool decode, bench::Counters& counters)
+{
+    static slave::EmptyExtState ext_state;
+    static slave::MasterInfo master_info;
+    master_info.checksum_alg = slave::BINLOG_CHECKSUM_ALG_CRC32;
+
+    slave::MemoryEventSource source(corpus.binlog.data(), corpus.binlog.size());
+    const char* buf;
+    unsigned long len;
+    while (source.next(buf, len))
+    {
+        ++counters.events;
+        counters.bytes += len;
+
+        slave::Basic_event_info bei;
+        if (!slave::read_log_event(buf, len, bei, nullptr, true, master_info))
+            continue;
+
+        if (bei.type == slave::TABLE_MAP_EVENT)
+        {
+            slave::Table_map_event_info tmi(bei.buf, bei.event_len);
+            corpus.rli.setTableName(tmi.m_table_id, tmi.m_tblnam, tmi.m_dbnam);
+        }
+        else if (bei.type == slave::WRITE_ROWS_EVENT || bei.type == slave::UPDATE_ROWS_EVENT)
+        {
+            if (decode && slave::skip_row_event(corpus.rli, bei, nullptr))
+                continue;
+            const bool is_update = bei.type == slave::UPDATE_ROWS_EVENT;
+            slave::Row_event_info roi(bei.buf, bei.event_len, is_update, true);
+            if (decode)
+                slave::apply_row_event(corpus.rli, bei, roi, ext_state, nullptr);
+        }
+    }
+}
+
+// Goes through the corpus with the raw event filter, which has no tables to let through
+void lapFiltered(Corpus& corpus, bench::Counters& counters)
+{
+    static const slave::RawEventFilter::tables_t tables;
+    static slave::RawEventFilter filter(tables);
+    static slave::MasterInfo master_info;
+    master_info.checksum_alg = slave::BINLOG_CHECKSUM_ALG_CRC32;
+
+    slave::MemoryEventSource source(corpus.binlog.data(), corpus.binlog.size());
+    const char* buf;
+    unsigned long len;
+    while (source.next(buf, len))
+    {
+        ++counters.events;
+        counters.bytes += len;
+
+        filter.feed(buf, len, nullptr, [](const char* data, unsigned long size)
+        {
+            slave::Basic_event_info bei;
+            slave::read_log_event(data, size, bei, nullptr, true, master_info);
+        });
+    }
+}
+
+void benchCorpus(bench::Runner& runner, Corpus& corpus)
+{
+    uint64_t rows = 0;
+    corpus.table->m_callback = [&rows](slave::RecordSet&) { ++rows; };
+
+    runner.run(corpus.name + "/parse", [&](bench::Counters& c) { lap(corpus, false, c); });
+    runner.run(corpus.name + "/rawfilter", [&](bench::Counters& c) { lapFiltered(corpus, c); });
+
+    static const std::pair<slave::RowType, const char*> row_types[] = {
+        {slave::RowType::Map, "map"}, {slave::RowType::Vector, "vector"}, {slave::RowType::View, "view"}};
+    for (const auto& row_type : row_types)
+    {
+        corpus.table->row_type = row_type.first;
+        runner.run(corpus.name + "/decode/" + row_type.second, [&](bench::Counters& c)
+        {
+            rows = 0;
+            lap(corpus, true, c);
+            c.rows += rows;
+        });
+    }
+
+    corpus.table->row_type = slave::RowType::Vector;
+    corpus.table->reuse_record_sets = true;
+    runner.run(corpus.name + "/decode/vector/pooled", [&](bench::Counters& c)
+    {
+        rows = 0;
+        lap(corpus, true, c);
+        c.rows += rows;
+    });
+    corpus.table->zero_copy_strings = true;
+    runner.run(corpus.name + "/decode/vector/zerocopy", [&](bench::Counters& c)
+    {
+        rows = 0;
+        lap(corpus, true, c);
+        c.rows += rows;
+    });
+    corpus.table->zero_copy_strings = false;
+    corpus.table->reuse_record_sets = false;
+
+    // A few columns of the table, as most consumers subscribe to
+    const auto& fields = corpus.table->fields;
+    corpus.table->set_column_filter({fields.front()->getFieldName(), fields[fields.size() / 2]->getFieldName(), fields.back()->getFieldName()});
+    runner.run(corpus.name + "/decode/vector/filter", [&](bench::Counters& c)
+    {
+        rows = 0;
+        lap(corpus, true, c);
+        c.rows += rows;
+    });
+    corpus.table->set_column_filter({});
+
+    // The table is subscribed to DELETE only, so all its events are dropped
+    corpus.table->m_filter = slave::eDelete;
+    runner.run(corpus.name + "/decode/skipped", [&](bench::Counters& c) { lap(corpus, true, c); });
+    corpus.table->m_filter = slave::eAll;
+    corpus.table->m_callback = nullptr;
+}
+
+#ifdef WITH_ZSTD
+// Unpacks events of the corpus, compressed as one transaction payload (events in a payload have no checksum)
+void benchPayload(bench::Runner& runner, Corpus& corpus)
+{
+    std::string events;
+    slave::MemoryEventSource source(corpus.binlog.data(), corpus.binlog.size());
+    const char* buf;
+    unsigned long len;
+    while (source.next(buf, len))
+    {
+        const uint32_t size = len - BINLOG_CHECKSUM_LEN;
+        events.append(buf, size);
+        ::memcpy(&events[events.size() - size + EVENT_LEN_OFFSET], &size, sizeof(size));
+    }
+
+    std::string compressed(ZSTD_compressBound(events.size()), '\0');
+    compressed.resize(ZSTD_compress(&compressed[0], compressed.size(), events.data(), events.size(), 3));
+
+    bench::BinlogWriter writer(false);
+    writer.transactionPayload(slave::Transaction_payload_event_info::Zstd, events.size(), compressed);
+    const std::string event = writer.data();
+    const slave::Transaction_payload_event_info tpi(event.data(), event.size());
+
+    slave::PayloadReader reader;
+    runner.run(corpus.name + "/payload/unpack", [&](bench::Counters& c)
+    {
+        reader.unpack(tpi, [&c](char*, unsigned long size)
+        {
+            ++c.events;
+            c.bytes += size;
+        });
+    });
+}
+#endif
+
+// Unpacks the same packed values by the field again and again
+void benchField(bench::Runner& runner, const std::string& name, slave::Field* field, const std::function<void (bench::RowPacker&, unsigned)>& pack)
+{
+    static const unsigned count = 1000;
+    bench::RowPacker packer(0);
+    for (unsigned i = 0; i < count; ++i)
+        pack(packer, i);
+    const std::string data = packer.data();
+    std::unique_ptr<slave::Field> owner(field);
+
+    runner.run("unpack/" + name, [&](bench::Counters& c)
+    {
+        const char* p = data.data();
+        for (unsigned i = 0; i < count; ++i)
+            p = field->unpack(p);
+        c.rows += count;
+        c.bytes += data.size();
+    });
+}
+
+void benchFields(bench::Runner& runner)
+{
+    benchField(runner, "tinyint", new slave::Field_num<int16, 1>("f", "tinyint(4)"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 1); });
+    benchField(runner, "smallint", new slave::Field_num<int16>("f", "smallint(6)"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 2); });
+    benchField(runner, "mediumint", new slave::Field_num<int32, 3>("f", "mediumint(9)"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 3); });
+    benchField(runner, "int", new slave::Field_num<int32>("f", "int(11)"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 4); });
+    benchField(runner, "bigint", new slave::Field_num<longlong>("f", "bigint(20)"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 8); });
+    benchField(runner, "int_unsigned", new slave::Field_num<uint32>("f", "int(10) unsigned"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 4); });
+    benchField(runner, "double", new slave::Field_num<double>("f", "double"),
+               [](bench::RowPacker& p, unsigned i) { p.real(i * 0.25); });
+    benchField(runner, "decimal(10,2)", new slave::Field_decimal("f", "decimal(10,2)", 12, 2, false),
+               [](bench::RowPacker& p, unsigned i) { p.decimal(i * 101, 10, 2); });
+    benchField(runner, "decimal(20,6)", new slave::Field_decimal("f", "decimal(20,6)", 22, 6, false),
+               [](bench::RowPacker& p, unsigned i) { p.decimal(uint64_t(i) * 1000003, 20, 6); });
+    benchField(runner, "decimal(18,4)", new slave::Field_decimal("f", "decimal(18,4)", 20, 4, false),
+               [](bench::RowPacker& p, unsigned i) { p.decimal(uint64_t(i) * 10007, 18, 4); });
+    benchField(runner, "decimal(18,4)/typed", new slave::Field_decimal("f", "decimal(18,4)", 20, 4, false, true),
+               [](bench::RowPacker& p, unsigned i) { p.decimal(uint64_t(i) * 10007, 18, 4); });
+    benchField(runner, "decimal(20,6)/typed", new slave::Field_decimal("f", "decimal(20,6)", 22, 6, false, true),
+               [](bench::RowPacker& p, unsigned i) { p.decimal(uint64_t(i) * 1000003, 20, 6); });
+    benchField(runner, "datetime(6)", new slave::Field_datetime("f", "datetime(6)", 6, false),
+               [](bench::RowPacker& p, unsigned i) { p.datetime(2020, 1 + i % 12, 1 + i % 28, i % 24, i % 60, i % 60, i); });
+    benchField(runner, "timestamp", new slave::Field_timestamp("f", "timestamp", 0, false),
+               [](bench::RowPacker& p, unsigned i) { p.timestamp(1500000000 + i); });
+    benchField(runner, "time", new slave::Field_time("f", "time", 0, false),
+               [](bench::RowPacker& p, unsigned i) { p.time(i % 24, i % 60, i % 60); });
+    benchField(runner, "date", new slave::Field_date("f", "date"),
+               [](bench::RowPacker& p, unsigned i) { p.date(2020, 1 + i % 12, 1 + i % 28); });
+    benchField(runner, "datetime(6)/typed", new slave::Field_datetime("f", "datetime(6)", 6, false, true),
+               [](bench::RowPacker& p, unsigned i) { p.datetime(2020, 1 + i % 12, 1 + i % 28, i % 24, i % 60, i % 60, i); });
+    benchField(runner, "timestamp/typed", new slave::Field_timestamp("f", "timestamp", 0, false, true),
+               [](bench::RowPacker& p, unsigned i) { p.timestamp(1500000000 + i); });
+    benchField(runner, "time/typed", new slave::Field_time("f", "time", 0, false, true),
+               [](bench::RowPacker& p, unsigned i) { p.time(i % 24, i % 60, i % 60); });
+    benchField(runner, "date/typed", new slave::Field_date("f", "date", true),
+               [](bench::RowPacker& p, unsigned i) { p.date(2020, 1 + i % 12, 1 + i % 28); });
+    benchField(runner, "year", new slave::Field_year("f", "year(4)"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i % 200, 1); });
+    benchField(runner, "varchar", new slave::Field_string("f", "varchar(64)", 64),
+               [](bench::RowPacker& p, unsigned i) { p.string("string value " + std::to_string(i)); });
+    benchField(runner, "blob", new slave::Field_blob("f", "blob", 65535),
+               [](bench::RowPacker& p, unsigned i) { p.string(std::string(1024, char('a' + i % 26)), 2); });
+    benchField(runner, "enum", new slave::Field_enum("f", "enum('red','green','blue')"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(1 + i % 3, 1); });
+    benchField(runner, "set", new slave::Field_set("f", "set('red','green','blue')"),
+               [](bench::RowPacker& p, unsigned i) { p.integer(1 + i % 7, 1); });
+    benchField(runner, "bit", new slave::Field_bit("f", "bit(8)", 8),
+               [](bench::RowPacker& p, unsigned i) { p.integer(i, 1); });
+}
+
+}// anonymous-namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+
+    std::unique_ptr<Corpus> corpora[] = {narrowCorpus(), wideCorpus(), blobCorpus(), temporalCorpus()};
+    for (auto& corpus : corpora)
+        benchCorpus(runner, *corpus);
+#ifdef WITH_ZSTD
+    for (auto& corpus : corpora)
+        benchPayload(runner, *corpus);
+#endif
+
+    benchFields(runner);
+    return 0;
+}
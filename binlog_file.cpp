@@ -0,0 +1,125 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "binlog_file.h"
+#include "slave_log_event.h"
+#include "Logging.h"
+
+using namespace slave;
+
+namespace
+{
+const char binlog_magic[] = "\xfe\x62\x69\x6e";
+}// anonymous-namespace
+
+BinlogFileSource::BinlogFileSource(const std::string& path, unsigned long pos, bool rotate)
+    : m_rotate(rotate)
+{
+    open(path);
+    if (pos > m_pos)
+        m_start_pos = pos;
+}
+
+BinlogFileSource::~BinlogFileSource()
+{
+    close();
+}
+
+void BinlogFileSource::open(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("BinlogFileSource: can not open " + path + ": " + ::strerror(errno));
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < (off_t)header_size) {
+        ::close(fd);
+        throw std::runtime_error("BinlogFileSource: " + path + " is not a binlog file");
+    }
+
+    void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        throw std::runtime_error("BinlogFileSource: can not map " + path + ": " + ::strerror(errno));
+    ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    close();
+    m_path = path;
+    m_data = static_cast<const char*>(data);
+    m_size = st.st_size;
+    m_pos = header_size;
+    m_start_pos = 0;
+
+    if (::memcmp(m_data, binlog_magic, header_size) != 0)
+        throw std::runtime_error("BinlogFileSource: " + path + " is not a binlog file");
+
+    // The first event is always format description
+    m_server_version = event_server_version(m_data + m_pos, event_length(m_data + m_pos, m_size - m_pos));
+
+    LOG_INFO(log, "Reading binlog file " << path << ", server version " << m_server_version);
+}
+
+void BinlogFileSource::close()
+{
+    if (m_data)
+        ::munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool BinlogFileSource::next(const char*& buf, unsigned long& len)
+{
+    while (true) {
+        len = m_pos < m_size ? event_length(m_data + m_pos, m_size - m_pos) : 0;
+        if (len) {
+            buf = m_data + m_pos;
+            m_pos += len;
+            if (m_start_pos) {
+                m_pos = m_start_pos;
+                m_start_pos = 0;
+            }
+            return true;
+        }
+
+        if (m_pos != m_size)
+            LOG_WARNING(log, "BinlogFileSource: incomplete event at " << m_path << ":" << m_pos);
+
+        if (!m_rotate)
+            return false;
+        const std::string next_path = nextFileName(m_path);
+        if (::access(next_path.c_str(), R_OK) != 0)
+            return false;
+        open(next_path);
+    }
+}
+
+std::string BinlogFileSource::logName() const
+{
+    const std::string::size_type slash = m_path.rfind('/');
+    return slash == std::string::npos ? m_path : m_path.substr(slash + 1);
+}
+
+std::string BinlogFileSource::nextFileName(const std::string& path)
+{
+    const std::string::size_type dot = path.rfind('.');
+    if (dot == std::string::npos || dot + 1 == path.size()
+     || path.find_first_not_of("0123456789", dot + 1) != std::string::npos)
+        throw std::runtime_error("BinlogFileSource: binlog file name " + path + " has no number");
+
+    // Keep leading zeroes, let the number grow wider if it has to
+    std::string result = path;
+    std::string::size_type i = result.size();
+    while (i > dot + 1 && result[i - 1] == '9')
+        result[--i] = '0';
+    if (i == dot + 1)
+        result.insert(i, 1, '1');
+    else
+        ++result[i - 1];
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef __SLAVE_BINLOG_FILE_H_
+#define __SLAVE_BINLOG_FILE_H_
+
+#include <string>
+
+#include "event_source.h"
+
+namespace slave
+{
+
+// Reads local binlog or relay log files event by event, see Slave::read_events().
+// Files are mapped into memory, so events are not copied. When a file ends, reading goes
+// on with the next numbered one (mysql-bin.000007 -> mysql-bin.000008), if it exists.
+class BinlogFileSource : public EventSource
+{
+public:
+    static const unsigned long header_size = 4;
+
+    // Opens the file and starts reading at pos. As the master does, the format description
+    // event of the file is returned first, whatever pos is given.
+    explicit BinlogFileSource(const std::string& path, unsigned long pos = header_size, bool rotate = true);
+    ~BinlogFileSource();
+
+    BinlogFileSource(const BinlogFileSource&) = delete;
+    BinlogFileSource& operator=(const BinlogFileSource&) = delete;
+
+    // Gets the next event, which is valid until the next call.
+    // Returns false at the end of the last file, or at the incomplete event in the end of it.
+    bool next(const char*& buf, unsigned long& len) override;
+
+    // Current file name without directory, as it is in binlog position
+    std::string logName() const;
+    // Current file and offset of the next event in it
+    Position position() const override { return Position(logName(), m_start_pos ? m_start_pos : m_pos); }
+    // Server version from format description event of the current file, i.e. 50720
+    int serverVersion() const override { return m_server_version; }
+
+    // Name of the next numbered file
+    static std::string nextFileName(const std::string& path);
+
+private:
+    void open(const std::string& path);
+    void close();
+
+    std::string     m_path;
+    const char*     m_data = nullptr;
+    unsigned long   m_size = 0;
+    unsigned long   m_pos = 0;
+    // Position to go to after format description event
+    unsigned long   m_start_pos = 0;
+    int             m_server_version = 0;
+    bool            m_rotate;
+};
+
+}// slave
+
+#endif
@@ -0,0 +1,205 @@
+#include <zlib.h>
+
+#include "crc32.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SLAVE_CRC32_PCLMUL
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define SLAVE_CRC32_ARMV8
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+
+namespace
+{
+
+uint32_t crc32_zlib(uint32_t crc, const unsigned char* buf, size_t len)
+{
+    // zlib takes uInt length
+    while (len) {
+        const unsigned int n = len > (1U << 30) ? (1U << 30) : len;
+        crc = ::crc32(crc, buf, n);
+        buf += n;
+        len -= n;
+    }
+    return crc;
+}
+
+#ifdef SLAVE_CRC32_PCLMUL
+
+// Folds 64-byte blocks with carry-less multiplication and reduces the result with Barrett
+// reduction, see "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+// by Intel. Constants are for bit-reflected CRC32 (0xEDB88320). Takes and returns inverted crc,
+// len must be at least 64 and a multiple of 16.
+__attribute__((target("pclmul,sse4.1")))
+uint32_t crc32_pclmul_fold(uint32_t crc, const unsigned char* buf, size_t len)
+{
+    alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+    x0 = _mm_load_si128((const __m128i*)k1k2);
+
+    buf += 64;
+    len -= 64;
+
+    // Fold 4 x 128 bits in parallel
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    // Fold into 128 bits
+    x0 = _mm_load_si128((const __m128i*)k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Fold the rest 128 bits at a time
+    while (len >= 16) {
+        x2 = _mm_loadu_si128((const __m128i*)buf);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    // Fold 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i*)k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128((const __m128i*)poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return _mm_extract_epi32(x1, 1);
+}
+
+uint32_t crc32_pclmul(uint32_t crc, const unsigned char* buf, size_t len)
+{
+    // Short tails are not worth folding
+    if (len >= 64) {
+        const size_t n = len & ~size_t(15);
+        crc = ~crc32_pclmul_fold(~crc, buf, n);
+        buf += n;
+        len -= n;
+    }
+    return crc32_zlib(crc, buf, len);
+}
+
+#endif // SLAVE_CRC32_PCLMUL
+
+#ifdef SLAVE_CRC32_ARMV8
+
+__attribute__((target("+crc")))
+uint32_t crc32_armv8(uint32_t crc, const unsigned char* buf, size_t len)
+{
+    crc = ~crc;
+    while (len && (reinterpret_cast<uintptr_t>(buf) & 7)) {
+        crc = __crc32b(crc, *buf++);
+        --len;
+    }
+    for (; len >= 8; len -= 8, buf += 8)
+        crc = __crc32d(crc, *reinterpret_cast<const uint64_t*>(buf));
+    while (len--)
+        crc = __crc32b(crc, *buf++);
+    return ~crc;
+}
+
+#endif // SLAVE_CRC32_ARMV8
+
+std::vector<slave::Crc32Impl> detect()
+{
+    std::vector<slave::Crc32Impl> result;
+#ifdef SLAVE_CRC32_PCLMUL
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+        result.push_back({"pclmul", &crc32_pclmul});
+#endif
+#ifdef SLAVE_CRC32_ARMV8
+    if (::getauxval(AT_HWCAP) & HWCAP_CRC32)
+        result.push_back({"armv8", &crc32_armv8});
+#endif
+    result.push_back({"zlib", &crc32_zlib});
+    return result;
+}
+
+}// anonymous-namespace
+
+namespace slave
+{
+
+const std::vector<Crc32Impl>& crc32_impls()
+{
+    static const std::vector<Crc32Impl> impls = detect();
+    return impls;
+}
+
+uint32_t checksum_crc32(uint32_t crc, const unsigned char* buf, size_t len)
+{
+    static const auto func = crc32_impls().front().func;
+    return func(crc, buf, len);
+}
+
+}// slave
@@ -0,0 +1,27 @@
+#ifndef __SLAVE_CRC32_H_
+#define __SLAVE_CRC32_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace slave
+{
+
+// CRC32 of binlog events, the same as zlib crc32(). Is computed by carry-less multiplication
+// folding (PCLMULQDQ) on x86-64, or by CRC32 instructions on ARMv8, if the CPU has them;
+// by zlib otherwise. The choice is made once, at the first call.
+uint32_t checksum_crc32(uint32_t crc, const unsigned char* buf, size_t len);
+
+struct Crc32Impl
+{
+    const char* name;
+    uint32_t (*func)(uint32_t crc, const unsigned char* buf, size_t len);
+};
+
+// Implementations supported by this CPU, the fastest first. The last one is always zlib.
+const std::vector<Crc32Impl>& crc32_impls();
+
+}// slave
+
+#endif
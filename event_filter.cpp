@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstring>
+#include <my_byteorder.h>
+
+#include "event_filter.h"
+#include "slave_log_event.h"
+
+namespace
+{
+
+// Query of QUERY event is "BEGIN", with or without the checksum after it
+bool is_begin(const char* buf, unsigned long len)
+{
+    static const char begin[] = "BEGIN";
+    static const size_t begin_len = sizeof(begin) - 1;
+
+    if (len < LOG_EVENT_HEADER_LEN + QUERY_HEADER_LEN)
+        return false;
+    const unsigned db_len = (unsigned char)buf[LOG_EVENT_HEADER_LEN + Q_DB_LEN_OFFSET];
+    const unsigned status_vars_len = uint2korr(buf + LOG_EVENT_HEADER_LEN + Q_STATUS_VARS_LEN_OFFSET);
+    const unsigned long offset = LOG_EVENT_HEADER_LEN + QUERY_HEADER_LEN + status_vars_len + db_len + 1;
+    if (offset > len)
+        return false;
+    const unsigned long query_len = len - offset;
+    return (query_len == begin_len || query_len == begin_len + BINLOG_CHECKSUM_LEN) &&
+           !std::memcmp(buf + offset, begin, begin_len);
+}
+
+}// anonymous-namespace
+
+namespace slave
+{
+
+RawEventFilter::Verdict RawEventFilter::check(const char* buf, unsigned long len, EventStatIface* event_stat)
+{
+    // Broken events are let through to fail in read_log_event()
+    if (len < LOG_EVENT_HEADER_LEN)
+        return Pass;
+
+    switch ((unsigned char)buf[EVENT_TYPE_OFFSET]) {
+
+    case TABLE_MAP_EVENT:
+        if (len < LOG_EVENT_HEADER_LEN + TABLE_MAP_HEADER_LEN + 2)
+            return Pass;
+        table_map_names(buf, len, m_names);
+        if (m_tables.find(m_names) == m_tables.cend())
+            return Drop;
+        m_table_ids.push_back(uint6korr(buf + LOG_EVENT_HEADER_LEN + TM_MAPID_OFFSET));
+        return Pass;
+
+    case WRITE_ROWS_EVENT_V1:
+    case UPDATE_ROWS_EVENT_V1:
+    case DELETE_ROWS_EVENT_V1:
+    case WRITE_ROWS_EVENT:
+    case UPDATE_ROWS_EVENT:
+    case DELETE_ROWS_EVENT: {
+        if (len < LOG_EVENT_HEADER_LEN + ROWS_MAPID_OFFSET + 6)
+            return Pass;
+        const unsigned long table_id = uint6korr(buf + LOG_EVENT_HEADER_LEN + ROWS_MAPID_OFFSET);
+        return std::find(m_table_ids.begin(), m_table_ids.end(), table_id) != m_table_ids.end() ? Pass : Drop;
+    }
+
+    case QUERY_EVENT:
+        finish(event_stat);
+        if (is_begin(buf, len)) {
+            m_begin.assign(buf, len);
+            m_begin_held = true;
+            return Hold;
+        }
+        // COMMIT and DDL
+        return Pass;
+
+    case XID_EVENT:
+    case GTID_LOG_EVENT:
+    case ANONYMOUS_GTID_LOG_EVENT:
+        finish(event_stat);
+        return Pass;
+
+    default:
+        return Pass;
+    }
+}
+
+void RawEventFilter::finish(EventStatIface* event_stat)
+{
+    if (m_begin_held && event_stat)
+        event_stat->tickEventSkipped(m_begin.size());
+    reset();
+}
+
+}// slave
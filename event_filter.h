@@ -0,0 +1,75 @@
+#ifndef __SLAVE_EVENT_FILTER_H_
+#define __SLAVE_EVENT_FILTER_H_
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SlaveStats.h"
+
+namespace slave
+{
+
+// Drops events of tables, which are not replicated, from the stream of raw events, before their
+// checksum is checked and they are parsed, see Slave::setRawEventFilter(). TABLE_MAP events are
+// checked by the names of the table, ROWS events - by the table id of TABLE_MAP events let through
+// in the same transaction. BEGIN is held back until the first event of its transaction is let
+// through, so transactions, which touch other tables only, are dropped as a whole, except of
+// GTID and XID (or COMMIT) events, which are kept to move the position.
+class RawEventFilter
+{
+public:
+    typedef std::set<std::pair<std::string, std::string>> tables_t;
+
+    explicit RawEventFilter(const tables_t& tables) : m_tables(tables) {}
+
+    // Calls deliver(buf, len) for the event, if it is let through, preceded by the held BEGIN.
+    // Dropped events are reported to event_stat.
+    template <typename Deliver>
+    void feed(const char* buf, unsigned long len, EventStatIface* event_stat, Deliver&& deliver)
+    {
+        switch (check(buf, len, event_stat)) {
+        case Pass:
+            if (m_begin_held) {
+                m_begin_held = false;
+                deliver(m_begin.data(), m_begin.size());
+            }
+            deliver(buf, len);
+            break;
+        case Drop:
+            if (event_stat)
+                event_stat->tickEventSkipped(len);
+            break;
+        case Hold:
+            break;
+        }
+    }
+
+    // Forgets the transaction, i.e. on reconnect, when it is read again
+    void reset()
+    {
+        m_begin_held = false;
+        m_table_ids.clear();
+    }
+
+private:
+    enum Verdict { Pass, Drop, Hold };
+
+    Verdict check(const char* buf, unsigned long len, EventStatIface* event_stat);
+    // Transaction is over, drops the held BEGIN
+    void finish(EventStatIface* event_stat);
+
+    const tables_t& m_tables;
+
+    // Ids of TABLE_MAP events let through in the current transaction
+    std::vector<unsigned long> m_table_ids;
+    std::pair<std::string, std::string> m_names;
+
+    std::string m_begin;
+    bool m_begin_held = false;
+};
+
+}// slave
+
+#endif
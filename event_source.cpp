@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <endian.h>
+
+#include "event_source.h"
+#include "slave_log_event.h"
+#include "Logging.h"
+
+#include <sql_common.h>
+
+namespace slave
+{
+
+unsigned long event_length(const char* data, size_t size)
+{
+    if (size < LOG_EVENT_HEADER_LEN)
+        return 0;
+    uint32_t len;
+    ::memcpy(&len, data + EVENT_LEN_OFFSET, sizeof(len));
+    len = le32toh(len);
+    if (len < LOG_EVENT_HEADER_LEN || len > size)
+        return 0;
+    return len;
+}
+
+int event_server_version(const char* buf, unsigned long len)
+{
+    if (len < LOG_EVENT_HEADER_LEN + ST_SERVER_VER_OFFSET + ST_SERVER_VER_LEN
+     || buf[EVENT_TYPE_OFFSET] != FORMAT_DESCRIPTION_EVENT)
+        return 0;
+
+    const std::string version(buf + LOG_EVENT_HEADER_LEN + ST_SERVER_VER_OFFSET, ST_SERVER_VER_LEN);
+    int major, minor, patch;
+    if (3 == sscanf(version.c_str(), "%d.%d.%d", &major, &minor, &patch))
+        return major * 10000 + minor * 100 + patch;
+    return 0;
+}
+
+MemoryEventSource::MemoryEventSource(const char* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_begin(0)
+{
+    if (size >= 4 && ::memcmp(data, "\xfe\x62\x69\x6e", 4) == 0)
+        m_begin = 4;
+    m_pos = m_begin;
+    m_server_version = event_server_version(m_data + m_begin, event_length(m_data + m_begin, m_size - m_begin));
+}
+
+bool MemoryEventSource::next(const char*& buf, unsigned long& len)
+{
+    len = event_length(m_data + m_pos, m_size - m_pos);
+    if (!len)
+        return false;
+    buf = m_data + m_pos;
+    m_pos += len;
+    return true;
+}
+
+MysqlEventSource::MysqlEventSource(MYSQL* mysql)
+    : m_mysql(mysql)
+    , m_received_bytes(socket_received_bytes(mysql->net.fd))
+    , m_packet_bytes(0)
+{}
+
+bool MysqlEventSource::next(const char*& buf, unsigned long& len)
+{
+#if MYSQL_VERSION_ID < 50705
+    len = cli_safe_read(m_mysql);
+#else
+    len = cli_safe_read(m_mysql, nullptr);
+#endif
+
+    if (len == packet_error) {
+        LOG_ERROR(log, "Myslave: Error reading packet from server: " << mysql_error(m_mysql)
+                  << "; mysql_error: " << mysql_errno(m_mysql));
+        return false;
+    }
+
+    m_packet_bytes += len + NET_HEADER_SIZE;
+
+    // check for end-of-data
+    if (len < 8 && m_mysql->net.read_pos[0] == 254) {
+
+        LOG_ERROR(log, "read_event(): end of data\n");
+        return false;
+    }
+
+    // Skip OK byte
+    buf = (const char*) m_mysql->net.read_pos + 1;
+    len -= 1;
+    return true;
+}
+
+void MysqlEventSource::takeTraffic(uint64_t& received_bytes, uint64_t& packet_bytes)
+{
+    const uint64_t received = socket_received_bytes(m_mysql->net.fd);
+    received_bytes = received >= m_received_bytes ? received - m_received_bytes : 0;
+    m_received_bytes = received;
+    packet_bytes = m_packet_bytes;
+    m_packet_bytes = 0;
+}
+
+}// slave
@@ -0,0 +1,83 @@
+#ifndef __SLAVE_EVENT_SOURCE_H_
+#define __SLAVE_EVENT_SOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <mysql.h>
+
+#include "binlog_pos.h"
+
+namespace slave
+{
+
+// Where binlog events come from, see Slave::read_events().
+class EventSource
+{
+public:
+    virtual ~EventSource() {}
+
+    // Gets the next event, which is valid until the next call.
+    // Returns false if there are no more events (or on error).
+    virtual bool next(const char*& buf, unsigned long& len) = 0;
+
+    // Version of the server, which has written the events, i.e. 50720. 0 if unknown.
+    virtual int serverVersion() const { return 0; }
+
+    // Position of the next event, empty if unknown
+    virtual Position position() const { return Position(); }
+};
+
+// Length of the complete event in the beginning of data, 0 if there is none
+unsigned long event_length(const char* data, size_t size);
+
+// Server version from format description event, 0 if the event is not one
+int event_server_version(const char* buf, unsigned long len);
+
+// Events, laid out one after another in memory, i.e. contents of a binlog file (with or without
+// the header). Memory is not copied and must outlive the source.
+class MemoryEventSource : public EventSource
+{
+public:
+    MemoryEventSource(const char* data, size_t size);
+
+    bool next(const char*& buf, unsigned long& len) override;
+    int serverVersion() const override { return m_server_version; }
+
+    // Starts over, i.e. to replay the same events in benchmarks
+    void rewind() { m_pos = m_begin; }
+
+private:
+    const char* m_data;
+    size_t      m_size;
+    size_t      m_begin;
+    size_t      m_pos;
+    int         m_server_version;
+};
+
+// Events of the live connection after COM_BINLOG_DUMP. Does not reconnect: returns false
+// on network error or end of data, mysql_errno() tells which one.
+class MysqlEventSource : public EventSource
+{
+public:
+    explicit MysqlEventSource(MYSQL* mysql);
+
+    bool next(const char*& buf, unsigned long& len) override;
+
+    // Traffic since the creation or the previous call: bytes received from the socket, which are
+    // compressed when protocol compression is on (0 if unknown), and bytes of the read packets
+    // with their headers after decompression
+    void takeTraffic(uint64_t& received_bytes, uint64_t& packet_bytes);
+
+private:
+    MYSQL*   m_mysql;
+    uint64_t m_received_bytes;
+    uint64_t m_packet_bytes;
+};
+
+// Bytes received from the TCP socket since it was opened, 0 if the system does not tell it
+uint64_t socket_received_bytes(int fd);
+
+}// slave
+
+#endif
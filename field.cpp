@@ -36,47 +36,85 @@
 
 namespace slave
 {
+// ----- base --------------------------------------------------------------------------------------
+
+int64_t Field::get_int64(const char* from) const
+{
+    throw std::runtime_error("Field::get_int64(): field '" + field_name + "' of type '" + field_type + "' is not an integer");
+}
+
+double Field::get_double(const char* from) const
+{
+    throw std::runtime_error("Field::get_double(): field '" + field_name + "' of type '" + field_type + "' is not a number");
+}
+
+StringRef Field::get_string_ref(const char* from) const
+{
+    throw std::runtime_error("Field::get_string_ref(): field '" + field_name + "' of type '" + field_type + "' is not a string");
+}
+
 // ----- numbers -----------------------------------------------------------------------------------
 
-template<> uint16 Field_num<uint16, 1>::get_value(const char *from) {
+template<> uint16 Field_num<uint16, 1>::get_value(const char *from) const {
     return *(const uchar*)from;
 }
-template<> uint16 Field_num<uint16>::get_value(const char *from) {
+template<> uint16 Field_num<uint16>::get_value(const char *from) const {
     return uint2korr(from);
 }
-template<> uint32 Field_num<uint32, 3>::get_value(const char *from) {
+template<> uint32 Field_num<uint32, 3>::get_value(const char *from) const {
     return uint3korr(from);
 }
-template<> uint32 Field_num<uint32>::get_value(const char *from) {
+template<> uint32 Field_num<uint32>::get_value(const char *from) const {
     return uint4korr(from);
 }
-template<> ulonglong Field_num<ulonglong>::get_value(const char *from) {
+template<> ulonglong Field_num<ulonglong>::get_value(const char *from) const {
     return uint8korr(from);
 }
 
-template<> int16 Field_num<int16, 1>::get_value(const char *from) {
+template<> int16 Field_num<int16, 1>::get_value(const char *from) const {
     return *from;
 }
-template<> int16 Field_num<int16>::get_value(const char *from) {
+template<> int16 Field_num<int16>::get_value(const char *from) const {
     return sint2korr(from);
 }
-template<> int32 Field_num<int32, 3>::get_value(const char *from) {
+template<> int32 Field_num<int32, 3>::get_value(const char *from) const {
     return sint3korr(from);
 }
-template<> int32 Field_num<int32>::get_value(const char *from) {
+template<> int32 Field_num<int32>::get_value(const char *from) const {
     return sint4korr(from);
 }
-template<> longlong Field_num<longlong>::get_value(const char *from) {
+template<> longlong Field_num<longlong>::get_value(const char *from) const {
     return sint8korr(from);
 }
 
-template<> float Field_num<float>::get_value(const char *from) {
+template<> float Field_num<float>::get_value(const char *from) const {
     return *(float*)from;
 }
-template<> double Field_num<double>::get_value(const char *from) {
+template<> double Field_num<double>::get_value(const char *from) const {
     return *(double*)from;
 }
 
+template<> DecodeOp::Kind Field_num<uint16, 1>::decode_kind() const { return DecodeOp::UInt8; }
+template<> DecodeOp::Kind Field_num<uint16>::decode_kind() const { return DecodeOp::UInt16; }
+template<> DecodeOp::Kind Field_num<uint32, 3>::decode_kind() const { return DecodeOp::UInt24; }
+template<> DecodeOp::Kind Field_num<uint32>::decode_kind() const { return DecodeOp::UInt32; }
+template<> DecodeOp::Kind Field_num<ulonglong>::decode_kind() const { return DecodeOp::UInt64; }
+
+template<> DecodeOp::Kind Field_num<int16, 1>::decode_kind() const { return DecodeOp::Int8; }
+template<> DecodeOp::Kind Field_num<int16>::decode_kind() const { return DecodeOp::Int16; }
+template<> DecodeOp::Kind Field_num<int32, 3>::decode_kind() const { return DecodeOp::Int24; }
+template<> DecodeOp::Kind Field_num<int32>::decode_kind() const { return DecodeOp::Int32; }
+template<> DecodeOp::Kind Field_num<longlong>::decode_kind() const { return DecodeOp::Int64; }
+
+template<> DecodeOp::Kind Field_num<float>::decode_kind() const { return DecodeOp::Float; }
+template<> DecodeOp::Kind Field_num<double>::decode_kind() const { return DecodeOp::Double; }
+
+template<typename T, const unsigned length>
+DecodeOp Field_num<T, length>::decode_op()
+{
+    return DecodeOp(decode_kind(), length, this);
+}
+
 template<typename T, const unsigned length>
 const char* Field_num<T, length>::unpack(const char* from)
 {
@@ -88,6 +126,18 @@ const char* Field_num<T, length>::unpack(const char* from)
     return from + length;
 }
 
+template<typename T, const unsigned length>
+int64_t Field_num<T, length>::get_int64(const char* from) const
+{
+    return get_value(from);
+}
+
+template<typename T, const unsigned length>
+double Field_num<T, length>::get_double(const char* from) const
+{
+    return get_value(from);
+}
+
 template<typename T, const unsigned length>
 void Field_num<T, length>::unpack_str(const std::string& from)
 {
@@ -97,13 +147,22 @@ void Field_num<T, length>::unpack_str(const std::string& from)
         s >> value;
         field_data = value;
     } else {
-        field_data = boost::any();
+        field_data = nullFieldValue();
     }
 }
 
 
 const char* Field_decimal::unpack(const char *from)
 {
+    if (typed) {
+        const Decimal value = Decimal::fromBinary(from, precision, scale);
+
+        LOG_TRACE(log, "field " << field_name << "  decimal: " << value.str() << " // " << length);
+
+        field_data = value;
+        return from + length;
+    }
+
     // see DECIMAL_BUFF_LENGTH @ my_decimal.h
     ::decimal_digit_t buf[ 9 ];
     ::decimal_t dec;
@@ -121,14 +180,32 @@ const char* Field_decimal::unpack(const char *from)
         throw std::runtime_error("Field_decimal::unpack(): decimal2string() failed");
     }
 
-    std::string value((char*)buffer, value_length);
-
-    LOG_TRACE(log, "field " << field_name << "  decimal: '" << value << "' // " << length);
+    LOG_TRACE(log, "field " << field_name << "  decimal: '" << std::string(buffer, value_length) << "' // " << length);
 
-    field_data = std::move(value);
+    field_data = FieldValue(buffer, value_length);
     return from + length;
 }
 
+double Field_decimal::get_double(const char* from) const
+{
+    if (precision <= Decimal::max_precision) {
+        return Decimal::fromBinary(from, precision, scale).toDouble();
+    }
+
+    ::decimal_digit_t buf[ 9 ];
+    ::decimal_t dec;
+    dec.len = 9;
+    dec.buf = buf;
+
+    if (dec_util::bin2dec(from, &dec, precision, scale) != E_DEC_OK) {
+        throw std::runtime_error("Field_decimal::get_double(): bin2dec() failed");
+    }
+
+    double value;
+    dec_util::dec2dbl(&dec, &value);
+    return value;
+}
+
 // ----- date & time -------------------------------------------------------------------------------
 
 void Field_timestamp::reset(const bool is_old_storage_, const bool ctor_call)
@@ -153,11 +230,23 @@ const char* Field_timestamp::unpack(const char* from)
     } else {
         ::my_timestamp_from_binary(&tv, (const uchar*)from, precision);
     }
+    if (typed) {
+        const Timestamp value(int64_t(tv.tv_sec) * 1000000 + tv.tv_usec, precision);
+
+        LOG_TRACE(log, "field " << field_name << "  timestamp: " << value.usec << " // " << length);
+
+        field_data = value;
+        return from + length;
+    }
     if (tv.tv_sec || tv.tv_usec) {
         // see localtime_to_TIME() @ sql_time.cc
         struct ::tm tm_;
-        time_t ts = tv.tv_sec;
-        ::localtime_r(&ts, &tm_);
+        if (time_zone) {
+            time_zone->localtime(tv.tv_sec, tm_, time_zone_cache);
+        } else {
+            time_t ts = tv.tv_sec;
+            ::localtime_r(&ts, &tm_);
+        }
 
         my_time.neg = 0;
         my_time.second_part = tv.tv_usec;
@@ -175,11 +264,9 @@ const char* Field_timestamp::unpack(const char* from)
     char buffer[ MAX_DATE_STRING_REP_LENGTH ];
     const int value_length = ::my_TIME_to_str(my_time, (char*)&buffer, precision);
 
-    std::string value((char*)&buffer, value_length);
-
-    LOG_TRACE(log, "field " << field_name << "  timestamp: '" << value << "' // " << length);
+    LOG_TRACE(log, "field " << field_name << "  timestamp: '" << std::string(buffer, value_length) << "' // " << length);
 
-    field_data = std::move(value);
+    field_data = FieldValue(buffer, value_length);
     return from + length;
 }
 
@@ -197,6 +284,34 @@ void Field_time::reset(const bool is_old_storage_, const bool ctor_call)
 }
 const char* Field_time::unpack(const char* from)
 {
+    if (typed) {
+        int64_t usec;
+        if (is_old_storage) {
+            // HHMMSS
+            const uint32 nr = uint3korr(from);
+            usec = int64_t(nr / 10000 * 3600 + nr / 100 % 100 * 60 + nr % 100) * 1000000;
+        } else {
+            // see TIME_from_longlong_time_packed() @ my_time.c
+            longlong nr = ::my_time_packed_from_binary((const uchar*)from, precision);
+            const bool neg = nr < 0;
+            if (neg) {
+                nr = -nr;
+            }
+            const longlong hms = nr >> 24;
+            usec = ((((hms >> 12) % (1 << 10)) * 60 + ((hms >> 6) % (1 << 6))) * 60 + hms % (1 << 6)) * 1000000
+                + nr % (1LL << 24);
+            if (neg) {
+                usec = -usec;
+            }
+        }
+        const Time value(usec, precision);
+
+        LOG_TRACE(log, "field " << field_name << "  time: " << value.usec << " // " << length);
+
+        field_data = value;
+        return from + length;
+    }
+
     ::MYSQL_TIME my_time = {0};
 
     if (is_old_storage) {
@@ -213,11 +328,9 @@ const char* Field_time::unpack(const char* from)
     char buffer[ MAX_DATE_STRING_REP_LENGTH ];
     const int value_length = ::my_TIME_to_str(my_time, (char*)&buffer, precision);
 
-    std::string value((char*)&buffer, value_length);
-
-    LOG_TRACE(log, "field " << field_name << "  time: '" << value << "' // " << length);
+    LOG_TRACE(log, "field " << field_name << "  time: '" << std::string(buffer, value_length) << "' // " << length);
 
-    field_data = std::move(value);
+    field_data = FieldValue(buffer, value_length);
     return from + length;
 }
 
@@ -235,6 +348,28 @@ void Field_datetime::reset(const bool is_old_storage_, const bool ctor_call)
 }
 const char* Field_datetime::unpack(const char* from)
 {
+    if (typed) {
+        DateTime value(0, 0, precision);
+        if (is_old_storage) {
+            value.packed = uint8korr(from);
+        } else {
+            // see TIME_from_longlong_datetime_packed() @ my_time.c
+            const longlong nr = ::my_datetime_packed_from_binary((const uchar*)from, precision);
+            const longlong ymdhms = nr >> 24;
+            const longlong ymd = ymdhms >> 17;
+            const longlong ym = ymd >> 5;
+            const longlong hms = ymdhms % (1 << 17);
+            value.packed = ((ym / 13) * 10000 + (ym % 13) * 100 + ymd % (1 << 5)) * 1000000ULL
+                + (hms >> 12) * 10000 + ((hms >> 6) % (1 << 6)) * 100 + hms % (1 << 6);
+            value.usec = nr % (1LL << 24);
+        }
+
+        LOG_TRACE(log, "field " << field_name << "  datetime: " << value.packed << "." << value.usec << " // " << length);
+
+        field_data = value;
+        return from + length;
+    }
+
     ::MYSQL_TIME my_time = {0};
 
     if (is_old_storage) {
@@ -251,11 +386,9 @@ const char* Field_datetime::unpack(const char* from)
     char buffer[ MAX_DATE_STRING_REP_LENGTH ];
     const int value_length = ::my_TIME_to_str(my_time, (char*)&buffer, precision);
 
-    std::string value((char*)&buffer, value_length);
-
-    LOG_TRACE(log, "field " << field_name << "  datetime: '" << value << "' // " << length);
+    LOG_TRACE(log, "field " << field_name << "  datetime: '" << std::string(buffer, value_length) << "' // " << length);
 
-    field_data = std::move(value);
+    field_data = FieldValue(buffer, value_length);
     return from + length;
 }
 
@@ -266,6 +399,14 @@ const char* Field_date::unpack(const char* from)
 
     // see Field_newdate::get_date_internal() @ field.cc
     longlong nr = uint3korr(from);
+    if (typed) {
+        const Date value(nr >> 9, (nr >> 5) & 15, nr & 31);
+
+        LOG_TRACE(log, "field " << field_name << "  date: " << value.days);
+
+        field_data = value;
+        return from + 3;
+    }
     my_time.day = nr & 31;
     my_time.month = (nr >> 5) & 15;
     my_time.year = (nr >> 9);
@@ -274,15 +415,17 @@ const char* Field_date::unpack(const char* from)
     char buffer[ MAX_DATE_STRING_REP_LENGTH ];
     const int value_length = ::my_TIME_to_str(my_time, (char*)&buffer, 0);
 
-    std::string value((char*)&buffer, value_length);
+    LOG_TRACE(log, "field " << field_name << "  date: '" << std::string(buffer, value_length) << "'");
 
-    LOG_TRACE(log, "field " << field_name << "  date: '" << value << "'");
-
-    field_data = std::move(value);
+    field_data = FieldValue(buffer, value_length);
     return from + 3;
 }
 
 
+int64_t Field_year::get_int64(const char* from) const
+{
+    return *(const uchar*)from + 1900;
+}
 const char* Field_year::unpack(const char* from)
 {
     uint16 value = *(const uchar*)from + 1900;
@@ -299,30 +442,34 @@ void Field_year::unpack_str(const std::string& from)
         s >> value;
         field_data = value;
     } else {
-        field_data = boost::any();
+        field_data = nullFieldValue();
     }
 }
 
 // ----- string ------------------------------------------------------------------------------------
 
-const char* Field_string::unpack(const char* from)
+StringRef Field_string::get_string_ref(const char* from) const
 {
-    size_t value_length;
     // see calc_pack_length() @ field.cc
     if (length < 256) {
-        value_length = *(const uchar*)from;
-        from++;
+        return StringRef(from + 1, *(const uchar*)from);
     } else {
-        value_length = uint2korr(from);
-        from += 2;
+        return StringRef(from + 2, uint2korr(from));
     }
+}
+size_t Field_string::pack_length(const char* from) const
+{
+    const StringRef ref = get_string_ref(from);
+    return ref.data + ref.size - from;
+}
+const char* Field_string::unpack(const char* from)
+{
+    const StringRef ref = get_string_ref(from);
 
-    std::string value(from, value_length);
-
-    LOG_TRACE(log, "field " << field_name << "  string size " << length << ": '" << value << "' // " << value_length);
+    LOG_TRACE(log, "field " << field_name << "  string size " << length << ": '" << ref.str() << "' // " << ref.size);
 
-    field_data = std::move(value);
-    return from + value_length;
+    field_data = FieldValue(ref.data, ref.size);
+    return ref.data + ref.size;
 }
 
 // ----- enums -------------------------------------------------------------------------------------
@@ -354,32 +501,43 @@ Field_bitset::Field_bitset(const std::string& name, const std::string& type) :
 }
 
 
+int64_t Field_enum::get_int64(const char* from) const
+{
+    return length == 1 ? *(const uchar*)from : uint2korr(from);
+}
+StringRef Field_enum::get_string_ref(const char* from) const
+{
+    const ulonglong nr = get_int64(from);
+    if (!nr)
+        return StringRef();
+    const std::string& value = str_values.at(nr - 1);
+    return StringRef(value.data(), value.size());
+}
 const char* Field_enum::unpack(const char* from)
 {
-    ulonglong nr = length == 1 ? *(const uchar*)from : uint2korr(from);
-
-    std::string value;
-    if (nr) value.assign(str_values.at(nr - 1));
+    const StringRef value = get_string_ref(from);
 
-    LOG_TRACE(log, "field " << field_name << "  enum size " << length << ": " << value);
+    LOG_TRACE(log, "field " << field_name << "  enum size " << length << ": " << value.str());
 
-    field_data = std::move(value);
+    field_data = FieldValue(value.data, value.size);
     return from + length;
 }
 
 
-const char* Field_set::unpack(const char* from)
+int64_t Field_set::get_int64(const char* from) const
 {
-    ulonglong nr = 0;
-
     switch (length) {
-        case 1: nr = *(const uchar*)from; break;
-        case 2: nr = uint2korr(from); break;
-        case 3: nr = uint3korr(from); break;
-        case 4: nr = uint4korr(from); break;
+        case 1: return *(const uchar*)from;
+        case 2: return uint2korr(from);
+        case 3: return uint3korr(from);
+        case 4: return uint4korr(from);
         default:
-        case 8: nr = uint8korr(from);
+        case 8: return uint8korr(from);
     }
+}
+const char* Field_set::unpack(const char* from)
+{
+    ulonglong nr = get_int64(from);
 
     std::string value;
 
@@ -394,12 +552,12 @@ const char* Field_set::unpack(const char* from)
 
     LOG_TRACE(log, "field " << field_name << "  set size " << length << ": " << value);
 
-    field_data = std::move(value);
+    field_data = value;
     return from + length;
 }
 
 
-const char* Field_bit::unpack(const char *from)
+int64_t Field_bit::get_int64(const char* from) const
 {
     unsigned long long value = 0;
 
@@ -407,10 +565,16 @@ const char* Field_bit::unpack(const char *from)
         value = (value << 8) | *from;
     }
 
+    return value;
+}
+const char* Field_bit::unpack(const char *from)
+{
+    unsigned long long value = get_int64(from);
+
     LOG_TRACE(log, "field " << field_name << "  bit size " << length << ": " << value);
 
     field_data = value;
-    return from;
+    return from + pack_length(from);
 }
 void Field_bit::unpack_str(const std::string& from)
 {
@@ -439,24 +603,29 @@ Field_blob::Field_blob(const std::string& name, const std::string& type, const u
         size = 4;
     }
 }
-const char* Field_blob::unpack(const char* from)
+StringRef Field_blob::get_string_ref(const char* from) const
 {
-    size_t value_length;
-
     switch (size) {
-        case 1: value_length = *(const uchar*)from++; break;
-        case 2: value_length = uint2korr(from); from += 2; break;
-        case 3: value_length = uint3korr(from); from += 3; break;
+        case 1: return StringRef(from + 1, *(const uchar*)from);
+        case 2: return StringRef(from + 2, uint2korr(from));
+        case 3: return StringRef(from + 3, uint3korr(from));
         default:
-        case 4: value_length = uint4korr(from); from += 4;
+        case 4: return StringRef(from + 4, uint4korr(from));
     }
+}
+size_t Field_blob::pack_length(const char* from) const
+{
+    const StringRef ref = get_string_ref(from);
+    return ref.data + ref.size - from;
+}
+const char* Field_blob::unpack(const char* from)
+{
+    const StringRef ref = get_string_ref(from);
 
-    std::string value(from, value_length);
-
-    LOG_TRACE(log, "field " << field_name << "  blob size " << size << ": '" << value << "' // " << value_length);
+    LOG_TRACE(log, "field " << field_name << "  blob size " << size << ": '" << ref.str() << "' // " << ref.size);
 
-    field_data = std::move(value);
-    return from + value_length;
+    field_data = FieldValue(ref.data, ref.size);
+    return ref.data + ref.size;
 }
 
 } // namespace slave
@@ -21,6 +21,8 @@
 #include <list>
 
 #include "collate.h"
+#include "slave_decimal.h"
+#include "timezone.h"
 #include "types.h"
 
 // conflict with macro defined in mysql
@@ -38,12 +40,36 @@ namespace slave
 {
 // ----- base --------------------------------------------------------------------------------------
 
+class Field;
+
+// Step of the table decoder, see Table::decode_plan. Fixed-size numbers are decoded by the row
+// loop itself, strings and blobs are taken by Field::get_string_ref(), other fields are decoded
+// by virtual Field::unpack().
+struct DecodeOp
+{
+    enum Kind : uint8_t {
+        Generic,
+        UInt8, UInt16, UInt24, UInt32, UInt64,
+        Int8, Int16, Int24, Int32, Int64,
+        Float, Double,
+        String
+    };
+
+    Kind     kind = Generic;
+    // Packed length, 0 if it depends on the value or on the table map (temporal types)
+    uint8_t  length = 0;
+    Field*   field = nullptr;
+
+    DecodeOp() {}
+    DecodeOp(Kind kind_, uint8_t length_, Field* field_) : kind(kind_), length(length_), field(field_) {}
+};
+
 class Field
 {
     public:
         const std::string field_name;
         const std::string field_type;
-        boost::any field_data;
+        FieldValue field_data;
 
         Field(const std::string& name, const std::string& type) :
             field_name(name), field_type(type)
@@ -52,6 +78,18 @@ class Field
         virtual ~Field() {}
         virtual const char* unpack(const char *from) = 0;
 
+        // Returns size of the packed value without unpacking it.
+        virtual size_t pack_length(const char* from) const = 0;
+
+        // How the table decoder should handle the field.
+        virtual DecodeOp decode_op() { return DecodeOp(DecodeOp::Generic, 0, this); }
+
+        // Typed accessors for RowView: decode packed value on demand, without touching field_data.
+        // Throw if the field has no such representation.
+        virtual int64_t get_int64(const char* from) const;
+        virtual double get_double(const char* from) const;
+        virtual StringRef get_string_ref(const char* from) const;
+
         virtual void unpack_str(const std::string& from) {
             field_data = from;
         }
@@ -72,8 +110,14 @@ class Field_num : public Field
         const char* unpack(const char* from);
         void unpack_str(const std::string& from);
 
+        size_t pack_length(const char* from) const { return length; }
+        int64_t get_int64(const char* from) const;
+        double get_double(const char* from) const;
+        DecodeOp decode_op();
+
     private:
-        inline T get_value(const char *from);
+        inline T get_value(const char *from) const;
+        inline DecodeOp::Kind decode_kind() const;
 };
 
 template class Field_num<uint16, 1>;
@@ -100,19 +144,27 @@ class Field_decimal : public Field
             const std::string& type,
             const unsigned length_,
             const unsigned scale_,
-            const bool is_unsigned
+            const bool is_unsigned,
+            const bool typed_ = false
         ) :
             Field(name, type),
             scale(scale_),
             // see my_decimal_length_to_precision() @ my_decimal.h
             precision(length_ - (scale_ ? 1 : 0) - (is_unsigned || !length_ ? 0 : 1)),
-            length(::decimal_bin_size(precision, scale_))
+            length(::decimal_bin_size(precision, scale_)),
+            typed(typed_ && precision <= Decimal::max_precision)
         {}
 
         const char* unpack(const char *from);
 
+        size_t pack_length(const char* from) const { return length; }
+        double get_double(const char* from) const;
+        DecodeOp decode_op() { return DecodeOp(DecodeOp::Generic, length, this); }
+
     private:
         const unsigned scale, precision, length;
+        // Unpack to Decimal instead of string
+        const bool typed;
         static const bool zerofill = false;
 };
 
@@ -124,18 +176,24 @@ class Field_temporal : public Field
         Field_temporal(
             const std::string& name,
             const std::string& type,
-            const unsigned precision_
+            const unsigned precision_,
+            const bool typed_
         ) :
             Field(name, type),
-            precision(precision_)
+            precision(precision_),
+            typed(typed_)
         {}
 
         // set length
         virtual void reset(const bool is_old_storage_, const bool ctor_call = false) = 0;
 
+        size_t pack_length(const char* from) const { return length; }
+
     protected:
         bool is_old_storage;
         const unsigned precision;
+        // Unpack to Timestamp, DateTime or Time instead of string
+        const bool typed;
         unsigned length;
 };
 
@@ -147,15 +205,23 @@ class Field_timestamp : public Field_temporal
             const std::string& name,
             const std::string& type,
             const unsigned precision,
-            const bool is_old_storage_
+            const bool is_old_storage_,
+            const bool typed = false,
+            const std::shared_ptr<const TimeZone>& time_zone_ = nullptr
         ) :
-            Field_temporal(name, type, precision)
+            Field_temporal(name, type, precision, typed),
+            time_zone(time_zone_)
         {
             reset(is_old_storage_, true);
         }
 
         const char* unpack(const char* from);
         void reset(const bool is_old_storage_, const bool ctor_call);
+
+    private:
+        // Converts to local time instead of localtime_r(), if is set
+        const std::shared_ptr<const TimeZone> time_zone;
+        TimeZone::Interval time_zone_cache;
 };
 
 
@@ -166,9 +232,10 @@ class Field_time : public Field_temporal
             const std::string& name,
             const std::string& type,
             const unsigned precision,
-            const bool is_old_storage_
+            const bool is_old_storage_,
+            const bool typed = false
         ) :
-            Field_temporal(name, type, precision)
+            Field_temporal(name, type, precision, typed)
         {
             reset(is_old_storage_, true);
         }
@@ -185,9 +252,10 @@ class Field_datetime : public Field_temporal
             const std::string& name,
             const std::string& type,
             const unsigned precision,
-            const bool is_old_storage_
+            const bool is_old_storage_,
+            const bool typed = false
         ) :
-            Field_temporal(name, type, precision)
+            Field_temporal(name, type, precision, typed)
         {
             reset(is_old_storage_, true);
         }
@@ -199,10 +267,24 @@ class Field_datetime : public Field_temporal
 
 class Field_date : public Field
 {
-    using Field::Field;
-
     public:
+        Field_date(
+            const std::string& name,
+            const std::string& type,
+            const bool typed_ = false
+        ) :
+            Field(name, type),
+            typed(typed_)
+        {}
+
         const char* unpack(const char* from);
+
+        size_t pack_length(const char* from) const { return 3; }
+        DecodeOp decode_op() { return DecodeOp(DecodeOp::Generic, 3, this); }
+
+    private:
+        // Unpack to Date instead of string
+        const bool typed;
 };
 
 
@@ -213,6 +295,9 @@ class Field_year : public Field
     public:
         const char* unpack(const char* from);
         void unpack_str(const std::string& from);
+
+        size_t pack_length(const char* from) const { return 1; }
+        int64_t get_int64(const char* from) const;
 };
 
 // ----- string ------------------------------------------------------------------------------------
@@ -231,6 +316,10 @@ class Field_string : public Field
 
         const char* unpack(const char* from);
 
+        size_t pack_length(const char* from) const;
+        StringRef get_string_ref(const char* from) const;
+        DecodeOp decode_op() { return DecodeOp(DecodeOp::String, 0, this); }
+
         void set_length(const unsigned x) {
             LOG_TRACE(log, "field " << field_name << " new string length: " << x);
             length = x;
@@ -247,6 +336,8 @@ class Field_bitset : public Field
     public:
         Field_bitset(const std::string& name, const std::string& type);
 
+        size_t pack_length(const char* from) const { return length; }
+
     protected:
         unsigned length;
         std::vector<std::string> str_values;
@@ -263,6 +354,10 @@ class Field_enum : public Field_bitset
         }
 
         const char* unpack(const char* from);
+
+        // Index of the value in enum definition, starting from 1
+        int64_t get_int64(const char* from) const;
+        StringRef get_string_ref(const char* from) const;
 };
 
 class Field_set: public Field_bitset
@@ -277,6 +372,9 @@ class Field_set: public Field_bitset
         }
 
         const char* unpack(const char* from);
+
+        // Bitmask of the values in set definition
+        int64_t get_int64(const char* from) const;
 };
 
 
@@ -295,6 +393,9 @@ class Field_bit : public Field
         const char* unpack(const char *from);
         void unpack_str(const std::string& from);
 
+        size_t pack_length(const char* from) const { return (length + 7) / 8; }
+        int64_t get_int64(const char* from) const;
+
     private:
         const unsigned length;
 };
@@ -310,6 +411,10 @@ class Field_blob : public Field {
         );
         const char* unpack(const char* from);
 
+        size_t pack_length(const char* from) const;
+        StringRef get_string_ref(const char* from) const;
+        DecodeOp decode_op() { return DecodeOp(DecodeOp::String, 0, this); }
+
         void set_size(const unsigned x) {
             LOG_TRACE(log, "field " << field_name << " new blob size: " << x);
             size = x;
@@ -0,0 +1,163 @@
+#include <limits>
+#include <stdexcept>
+
+#include "field_value.h"
+
+namespace slave
+{
+
+// Layout of m_data by kind:
+//   numbers           the value at 0
+//   String, inline    bytes at 0, size at 14
+//   String, heap      char* at 0, uint32_t size at 8, on_heap at 14
+//   String, reference const char* at 0, uint32_t size at 8, by_ref at 14
+//   Timestamp, Time   int64_t usec at 0, precision at 8
+//   DateTime          uint64_t packed at 0, uint32_t usec at 8, precision at 12
+//   Date              int32_t days at 0
+//   Decimal, inline   int64_t value at 0, precision at 8, scale at 9
+//   Decimal, heap     Decimal* at 0, on_heap at 14
+
+FieldValue::FieldValue(const slave::Timestamp& v)
+{
+    set(Kind::Timestamp, v.usec);
+    set(Kind::Timestamp, v.precision, 8);
+}
+
+FieldValue::FieldValue(const slave::DateTime& v)
+{
+    set(Kind::DateTime, v.packed);
+    set(Kind::DateTime, v.usec, 8);
+    set(Kind::DateTime, v.precision, 12);
+}
+
+FieldValue::FieldValue(const slave::Time& v)
+{
+    set(Kind::Time, v.usec);
+    set(Kind::Time, v.precision, 8);
+}
+
+FieldValue::FieldValue(const slave::Decimal& v)
+{
+    if (v.fitsInt64()) {
+        set(Kind::Decimal, v.unscaled());
+        set(Kind::Decimal, v.precision, 8);
+        set(Kind::Decimal, v.scale, 9);
+        m_data[heap_flag] = 0;
+    } else {
+        set(Kind::Decimal, new slave::Decimal(v));
+        m_data[heap_flag] = on_heap;
+    }
+}
+
+FieldValue FieldValue::reference(const StringRef& ref)
+{
+    if (ref.size <= inline_size || ref.size > std::numeric_limits<uint32_t>::max())
+        return FieldValue(ref.data, ref.size);
+    FieldValue v;
+    v.set(Kind::String, ref.data);
+    v.set(Kind::String, uint32_t(ref.size), 8);
+    v.m_data[heap_flag] = by_ref;
+    return v;
+}
+
+void FieldValue::setString(const char* data, size_t size)
+{
+    m_kind = Kind::String;
+    if (size <= inline_size) {
+        std::memcpy(m_data, data, size);
+        m_data[heap_flag] = size;
+        return;
+    }
+    if (size > std::numeric_limits<uint32_t>::max())
+        throw std::length_error("FieldValue: string is too long");
+    char* copy = new char[size];
+    std::memcpy(copy, data, size);
+    set(Kind::String, copy);
+    set(Kind::String, uint32_t(size), 8);
+    m_data[heap_flag] = on_heap;
+}
+
+StringRef FieldValue::getString() const
+{
+    if (m_data[heap_flag] == on_heap || m_data[heap_flag] == by_ref)
+        return StringRef(load<const char*>(), load<uint32_t>(8));
+    return StringRef((const char*)m_data, m_data[heap_flag]);
+}
+
+void FieldValue::copy(const FieldValue& other)
+{
+    if (!other.onHeap()) {
+        std::memcpy(m_data, other.m_data, sizeof(m_data));
+        m_kind = other.m_kind;
+    } else if (other.m_kind == Kind::String) {
+        const StringRef s = other.getString();
+        setString(s.data, s.size);
+    } else {
+        set(Kind::Decimal, new slave::Decimal(*other.load<const slave::Decimal*>()));
+        m_data[heap_flag] = on_heap;
+    }
+}
+
+void FieldValue::releaseHeap()
+{
+    if (m_kind == Kind::String)
+        delete[] load<char*>();
+    else
+        delete load<slave::Decimal*>();
+    m_kind = Kind::Null;
+}
+
+const std::type_info& FieldValue::type() const
+{
+    switch (m_kind) {
+        case Kind::Null:      return typeid(void);
+        case Kind::Char:      return typeid(char);
+        case Kind::Int16:     return typeid(int16_t);
+        case Kind::UInt16:    return typeid(uint16_t);
+        case Kind::Int32:     return typeid(int32_t);
+        case Kind::UInt32:    return typeid(uint32_t);
+        case Kind::Int64:     return typeid(long long);
+        case Kind::UInt64:    return typeid(unsigned long long);
+        case Kind::Float:     return typeid(float);
+        case Kind::Double:    return typeid(double);
+        case Kind::String:    return typeid(std::string);
+        case Kind::Timestamp: return typeid(slave::Timestamp);
+        case Kind::DateTime:  return typeid(slave::DateTime);
+        case Kind::Date:      return typeid(slave::Date);
+        case Kind::Time:      return typeid(slave::Time);
+        case Kind::Decimal:   return typeid(slave::Decimal);
+    }
+    return typeid(void);
+}
+
+template <>
+slave::Timestamp FieldValue::get<slave::Timestamp>() const
+{
+    check(Kind::Timestamp);
+    return slave::Timestamp(load<int64_t>(), m_data[8]);
+}
+
+template <>
+slave::DateTime FieldValue::get<slave::DateTime>() const
+{
+    check(Kind::DateTime);
+    return slave::DateTime(load<uint64_t>(), load<uint32_t>(8), m_data[12]);
+}
+
+template <>
+slave::Time FieldValue::get<slave::Time>() const
+{
+    check(Kind::Time);
+    return slave::Time(load<int64_t>(), m_data[8]);
+}
+
+template <>
+slave::Decimal FieldValue::get<slave::Decimal>() const
+{
+    check(Kind::Decimal);
+    if (m_data[heap_flag] == on_heap)
+        return *load<const slave::Decimal*>();
+    return slave::Decimal(load<int64_t>(), m_data[8], m_data[9]);
+}
+
+}// slave
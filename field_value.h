@@ -0,0 +1,194 @@
+#ifndef __SLAVE_FIELD_VALUE_H_
+#define __SLAVE_FIELD_VALUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <typeinfo>
+
+#include "slave_decimal.h"
+#include "temporal.h"
+
+namespace slave
+{
+
+// Non-owning reference to a string value inside of the binlog event buffer.
+struct StringRef
+{
+    const char* data = "";
+    size_t      size = 0;
+
+    StringRef() {}
+    StringRef(const char* d, size_t s) : data(d), size(s) {}
+
+    std::string str() const { return std::string(data, size); }
+};
+
+// Value of the field in a row: NULL, number, string or typed temporal/decimal value.
+// It takes 16 bytes, 15 of storage and the tag. Numbers, temporal values, decimals, which fit
+// in int64, and strings up to FieldValue::inline_size bytes are kept inline, so decoding of such
+// a row does not allocate memory. Longer strings and blobs are copied into one heap block, or,
+// in zero-copy mode (see Slave::setZeroCopyStrings()), refer to the binlog event buffer.
+class FieldValue
+{
+public:
+    enum class Kind : uint8_t {
+        Null,
+        Char, Int16, UInt16, Int32, UInt32, Int64, UInt64,
+        Float, Double,
+        String,
+        Timestamp, DateTime, Date, Time,
+        Decimal
+    };
+
+    static const size_t inline_size = 14;
+
+    FieldValue() : m_kind(Kind::Null) {}
+    FieldValue(std::nullptr_t) : m_kind(Kind::Null) {}
+
+    FieldValue(char v)               { set(Kind::Char, v); }
+    FieldValue(int16_t v)            { set(Kind::Int16, v); }
+    FieldValue(uint16_t v)           { set(Kind::UInt16, v); }
+    FieldValue(int32_t v)            { set(Kind::Int32, v); }
+    FieldValue(uint32_t v)           { set(Kind::UInt32, v); }
+    FieldValue(long v)               { set(Kind::Int64, int64_t(v)); }
+    FieldValue(unsigned long v)      { set(Kind::UInt64, uint64_t(v)); }
+    FieldValue(long long v)          { set(Kind::Int64, int64_t(v)); }
+    FieldValue(unsigned long long v) { set(Kind::UInt64, uint64_t(v)); }
+    FieldValue(float v)              { set(Kind::Float, v); }
+    FieldValue(double v)             { set(Kind::Double, v); }
+
+    // Strings are copied
+    FieldValue(const char* data, size_t size) { setString(data, size); }
+    FieldValue(const std::string& v) { setString(v.data(), v.size()); }
+
+    // The string is not copied, if it does not fit inline: the value refers to it, and it must
+    // outlive the value (and its copies) or materialize() must be called.
+    static FieldValue reference(const StringRef& ref);
+
+    FieldValue(const slave::Timestamp& v);
+    FieldValue(const slave::DateTime& v);
+    FieldValue(const slave::Date& v) { set(Kind::Date, v.days); }
+    FieldValue(const slave::Time& v);
+    FieldValue(const slave::Decimal& v);
+
+    FieldValue(const FieldValue& other) : m_kind(Kind::Null) { copy(other); }
+    FieldValue(FieldValue&& other) noexcept { steal(other); }
+    ~FieldValue() { release(); }
+
+    FieldValue& operator=(const FieldValue& other)
+    {
+        if (this != &other) {
+            release();
+            copy(other);
+        }
+        return *this;
+    }
+    FieldValue& operator=(FieldValue&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    Kind kind() const { return m_kind; }
+    bool isNull() const { return m_kind == Kind::Null; }
+    // The same as boost::any gave, so the code written for it works: empty() for NULL and
+    // type() of the stored value, typeid(void) for NULL.
+    bool empty() const { return isNull(); }
+    const std::type_info& type() const;
+
+    // If the value refers to a string, which it does not own (see reference())
+    bool isReference() const { return m_kind == Kind::String && m_data[heap_flag] == by_ref; }
+    // Copies the referred string into the value, so it does not depend on the buffer any more
+    void materialize()
+    {
+        if (isReference())
+            setString(load<const char*>(), load<uint32_t>(8));
+    }
+
+    // Typed getters: T must be the stored type (i.e. uint32_t for unsigned INT, std::string for
+    // VARCHAR), otherwise std::bad_cast is thrown. Strings can be taken as std::string (copy)
+    // or as StringRef, which points into the value and is valid while the value is not changed.
+    template <typename T>
+    T get() const;
+
+private:
+    // m_data[heap_flag] tells that the string or the decimal is on the heap,
+    // or that the string is referred to
+    static const size_t heap_flag = 14;
+    static const unsigned char on_heap = 0xff;
+    static const unsigned char by_ref = 0xfe;
+
+    template <typename T>
+    void set(Kind kind, T v, size_t offset = 0)
+    {
+        m_kind = kind;
+        std::memcpy(m_data + offset, &v, sizeof(v));
+    }
+
+    template <typename T>
+    T load(size_t offset = 0) const
+    {
+        T v;
+        std::memcpy(&v, m_data + offset, sizeof(v));
+        return v;
+    }
+
+    void check(Kind kind) const
+    {
+        if (m_kind != kind)
+            throw std::bad_cast();
+    }
+
+    bool onHeap() const { return (m_kind == Kind::String || m_kind == Kind::Decimal) && m_data[heap_flag] == on_heap; }
+
+    void setString(const char* data, size_t size);
+    StringRef getString() const;
+    void copy(const FieldValue& other);
+    void release() { if (onHeap()) releaseHeap(); }
+    void releaseHeap();
+
+    void steal(FieldValue& other)
+    {
+        std::memcpy(m_data, other.m_data, sizeof(m_data));
+        m_kind = other.m_kind;
+        other.m_kind = Kind::Null;
+    }
+
+    alignas(8) unsigned char m_data[15];
+    Kind m_kind;
+};
+
+static_assert(sizeof(FieldValue) == 16, "FieldValue must take 16 bytes");
+
+template <> inline char FieldValue::get<char>() const { check(Kind::Char); return load<char>(); }
+template <> inline int16_t FieldValue::get<int16_t>() const { check(Kind::Int16); return load<int16_t>(); }
+template <> inline uint16_t FieldValue::get<uint16_t>() const { check(Kind::UInt16); return load<uint16_t>(); }
+template <> inline int32_t FieldValue::get<int32_t>() const { check(Kind::Int32); return load<int32_t>(); }
+template <> inline uint32_t FieldValue::get<uint32_t>() const { check(Kind::UInt32); return load<uint32_t>(); }
+template <> inline long FieldValue::get<long>() const { check(Kind::Int64); return load<int64_t>(); }
+template <> inline unsigned long FieldValue::get<unsigned long>() const { check(Kind::UInt64); return load<uint64_t>(); }
+template <> inline long long FieldValue::get<long long>() const { check(Kind::Int64); return load<int64_t>(); }
+template <> inline unsigned long long FieldValue::get<unsigned long long>() const { check(Kind::UInt64); return load<uint64_t>(); }
+template <> inline float FieldValue::get<float>() const { check(Kind::Float); return load<float>(); }
+template <> inline double FieldValue::get<double>() const { check(Kind::Double); return load<double>(); }
+template <> inline StringRef FieldValue::get<StringRef>() const { check(Kind::String); return getString(); }
+template <> inline std::string FieldValue::get<std::string>() const { return get<StringRef>().str(); }
+template <> inline slave::Date FieldValue::get<slave::Date>() const { check(Kind::Date); return slave::Date(load<int32_t>()); }
+template <> slave::Timestamp FieldValue::get<slave::Timestamp>() const;
+template <> slave::DateTime FieldValue::get<slave::DateTime>() const;
+template <> slave::Time FieldValue::get<slave::Time>() const;
+template <> slave::Decimal FieldValue::get<slave::Decimal>() const;
+
+inline FieldValue nullFieldValue() { return FieldValue(); }
+inline bool isNullFieldValue(const FieldValue& v) { return v.isNull(); }
+template <typename T>
+T get(const FieldValue& v) { return v.get<T>(); }
+
+}// slave
+
+#endif
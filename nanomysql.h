@@ -37,6 +37,12 @@ struct mysql_conn_opts
     unsigned int mysql_connect_timeout  = 10;
     unsigned int mysql_read_timeout     = 60 * 15;
     unsigned int mysql_write_timeout    = 60 * 15;
+    // Protocol compression, the same as --compression-algorithms of mysql client: comma-separated
+    // "zlib", "zstd" and "uncompressed", i.e. "zstd,zlib" to let the server choose.
+    // Empty - no compression. zstd needs the client library and the server of 8.0.18 or newer.
+    std::string mysql_compression;
+    // Level of zstd compression, 1..22
+    unsigned int mysql_zstd_level       = 3;
 };
 
 class Connection {
@@ -71,6 +77,8 @@ class Connection {
 
     void connect(const mysql_conn_opts& opts)
     {
+        checkOptions(opts);
+
         m_conn = mysql_guard::mysql_safe_init(NULL);
 
         if (!m_conn)
@@ -105,8 +113,52 @@ class Connection {
     }
 
 public:
+    // Requested protocol compression algorithms
+    struct Compression
+    {
+        bool zlib = false;
+        bool zstd = false;
+        bool uncompressed = false;
+    };
+
+    // Throws on invalid options, which mysql_options() ignores silently
+    static Compression checkOptions(const mysql_conn_opts& opts)
+    {
+        Compression compression;
+        if (opts.mysql_compression.empty())
+            return compression;
+
+        size_t begin = 0;
+        while (begin <= opts.mysql_compression.size())
+        {
+            size_t end = opts.mysql_compression.find(',', begin);
+            if (end == std::string::npos)
+                end = opts.mysql_compression.size();
+            const std::string name = opts.mysql_compression.substr(begin, end - begin);
+            if (name == "zlib")
+                compression.zlib = true;
+            else if (name == "zstd")
+                compression.zstd = true;
+            else if (name == "uncompressed")
+                compression.uncompressed = true;
+            else
+                throw std::runtime_error("Unknown algorithm '" + name + "' in mysql_compression: " + opts.mysql_compression);
+            begin = end + 1;
+        }
+#if MYSQL_VERSION_ID < 80018
+        if (compression.zstd)
+            throw std::runtime_error("Only zlib protocol compression is supported by this client library, "
+                                     "mysql_compression: " + opts.mysql_compression);
+#endif
+        if (opts.mysql_zstd_level < 1 || opts.mysql_zstd_level > 22)
+            throw std::runtime_error("mysql_zstd_level must be from 1 to 22, got " + std::to_string(opts.mysql_zstd_level));
+        return compression;
+    }
+
     static void setOptions(MYSQL* connection, const mysql_conn_opts& opts)
     {
+        const Compression compression = checkOptions(opts);
+
         const unsigned int connect_timeout = opts.mysql_connect_timeout;
         const unsigned int read_timeout = opts.mysql_read_timeout;
         const unsigned int write_timeout = opts.mysql_write_timeout;
@@ -134,6 +186,18 @@ public:
                      , nullptr
                      , nullptr
                      );
+
+        if (!opts.mysql_compression.empty())
+        {
+#if MYSQL_VERSION_ID >= 80018
+            mysql_options(connection, MYSQL_OPT_COMPRESSION_ALGORITHMS, opts.mysql_compression.c_str());
+            if (compression.zstd)
+                mysql_options(connection, MYSQL_OPT_ZSTD_COMPRESSION_LEVEL, &opts.mysql_zstd_level);
+#else
+            if (compression.zlib)
+                mysql_options(connection, MYSQL_OPT_COMPRESS, nullptr);
+#endif
+        }
     }
 
     Connection(const mysql_conn_opts& opts)
@@ -0,0 +1,235 @@
+#ifndef __SLAVE_PIPELINE_H_
+#define __SLAVE_PIPELINE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "binlog_pos.h"
+#include "recordset.h"
+#include "table.h"
+#include "transaction.h"
+
+namespace slave
+{
+
+// Bounded ring of slots, which pass through a fixed number of stages in order.
+// Every stage is run by exactly one thread. Slot is available to the stage when
+// the previous stage has released it; to the first stage - when the last one has
+// released it on the previous lap. Cursors are lock-free, the mutex is taken only
+// to fall asleep when there is nothing to do, and to wake up the sleepers.
+template <typename T, unsigned Stages>
+class Ring
+{
+public:
+    explicit Ring(size_t size)
+    {
+        size_t n = 1;
+        while (n < size)
+            n <<= 1;
+        m_slots.resize(n);
+        m_mask = n - 1;
+        for (auto& c : m_cursors)
+            c = 0;
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    size_t size() const { return m_slots.size(); }
+
+    // Waits for the next slot of the stage
+    T& acquire(unsigned stage)
+    {
+        const size_t pos = m_cursors[stage].load(std::memory_order_relaxed);
+        if (stage == 0) {
+            const size_t n = m_slots.size();
+            wait([this, pos, n] { return m_cursors[Stages - 1].load() + n > pos; });
+        }
+        else
+            wait([this, pos, stage] { return m_cursors[stage - 1].load() > pos; });
+        return m_slots[pos & m_mask];
+    }
+
+    // Passes the slot, got by acquire(), to the next stage
+    void release(unsigned stage)
+    {
+        m_cursors[stage].fetch_add(1);
+        notify();
+    }
+
+    // Waits until all slots, released by the stage, are released by the last stage
+    void drain(unsigned stage = 0)
+    {
+        const size_t pos = m_cursors[stage].load();
+        wait([this, pos] { return m_cursors[Stages - 1].load() >= pos; });
+    }
+
+private:
+    template <typename Pred>
+    void wait(Pred pred)
+    {
+        for (unsigned i = 0; i < 100; ++i) {
+            if (pred())
+                return;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_sleepers;
+        m_cond.wait(lock, pred);
+        --m_sleepers;
+    }
+
+    void notify()
+    {
+        if (m_sleepers.load()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cond.notify_all();
+        }
+    }
+
+    std::vector<T> m_slots;
+    size_t m_mask;
+
+    std::atomic<size_t> m_cursors[Stages];
+    std::atomic<int> m_sleepers {0};
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+// One binlog event in the pipeline, see Slave::enablePipeline().
+// Reader fills the packet, decoder parses it and fills the actions,
+// dispatcher runs the actions (user callbacks, position updates) in order.
+struct PipelineSlot
+{
+    enum Kind { Event, Reconnected, Stop };
+
+    Kind kind = Event;
+    std::vector<char> packet;
+    // Events of TRANSACTION_PAYLOAD_EVENT, rows of the slot may refer to them
+    std::vector<char> payload;
+
+    std::vector<std::function<void()>> actions;
+
+    struct Record
+    {
+        const Table* table = nullptr;
+        RecordSet    rs;
+    };
+
+    // Batch of one ROWS event; a payload event brings several of them
+    struct Batch
+    {
+        const Table*                 table = nullptr;
+        RecordSetBatch               rows;
+        std::deque<RowView::cells_t> cells;
+    };
+
+    // Arguments of the actions. Containers are reused from lap to lap.
+    std::deque<Record>           records;
+    std::deque<RowView::cells_t> cells;
+    std::deque<Batch>            batches;
+    size_t                       records_used = 0;
+    size_t                       cells_used = 0;
+    size_t                       batches_used = 0;
+    Transaction                  transaction;
+    Position                     position;
+    time_t                       when = 0;
+    unsigned long                log_pos = 0;
+    unsigned int                 server_id = 0;
+
+    void reset()
+    {
+        actions.clear();
+        records_used = 0;
+        cells_used = 0;
+        batches_used = 0;
+    }
+
+    Record& nextRecord()
+    {
+        if (records_used == records.size())
+            records.emplace_back();
+        return records[records_used++];
+    }
+
+    RowView::cells_t& nextCells()
+    {
+        if (cells_used == cells.size())
+            cells.emplace_back();
+        return cells[cells_used++];
+    }
+
+    Batch& nextBatch()
+    {
+        if (batches_used == batches.size())
+            batches.emplace_back();
+        return batches[batches_used++];
+    }
+};
+
+typedef Ring<PipelineSlot, 3> PipelineRing;
+
+// Moves rows of tables into the slot being decoded, to be dispatched later.
+class PipelineSink : public RecordSink
+{
+public:
+    // Slot being decoded
+    PipelineSlot* slot = nullptr;
+    // Dispatcher passes rows here if set, otherwise calls table callbacks
+    RecordSink* next = nullptr;
+
+    void push(const Table& table, RecordSet& rs) override
+    {
+        PipelineSlot::Record& record = slot->nextRecord();
+        record.table = &table;
+        record.rs = std::move(rs);
+        RecordSet& r = record.rs;
+
+        // Cells of the table are overwritten by the next row, so take them
+        if (table.row_type == RowType::View) {
+            auto& cells = slot->nextCells();
+            cells.swap(table.view_cells);
+            r.m_row_view = RowView(table, cells);
+            if (r.type_event == RecordSet::Update) {
+                auto& old_cells = slot->nextCells();
+                old_cells.swap(table.old_view_cells);
+                r.m_old_row_view = RowView(table, old_cells);
+            }
+        }
+
+        slot->actions.emplace_back([this, &record]
+        {
+            if (next)
+                next->push(*record.table, record.rs);
+            else
+                record.table->m_callback(record.rs);
+        });
+    }
+
+    void pushBatch(const Table& table, RecordSetBatch& batch) override
+    {
+        // Swapping keeps elements in place, so views of the batch stay valid
+        PipelineSlot::Batch& b = slot->nextBatch();
+        b.table = &table;
+        b.rows.swap(batch);
+        b.cells.swap(table.batch_view_cells);
+
+        slot->actions.emplace_back([this, &b]
+        {
+            if (next)
+                next->pushBatch(*b.table, b.rows);
+            else
+                b.table->m_batch_callback(b.rows);
+        });
+    }
+};
+
+}// slave
+
+#endif
@@ -15,17 +15,22 @@
 #ifndef __SLAVE_RECORDSET_H_
 #define __SLAVE_RECORDSET_H_
 
+#include <functional>
 #include <map>
 #include <string>
+#include <vector>
 
+#include "rowview.h"
+#include "schema.h"
 #include "types.h"
 
 namespace slave
 {
 
-// One row in a table. Key -- field name, value - pair of (field type, value)
-typedef std::vector<std::pair<std::string, FieldValue>> RowVector;
-typedef std::map<std::string, std::pair<std::string, FieldValue>> Row;
+// One row in a table. Key -- field name, value - pair of (field type, value).
+// Names and types are interned, see SchemaString.
+typedef std::vector<std::pair<SchemaString, FieldValue>> RowVector;
+typedef std::map<SchemaString, std::pair<SchemaString, FieldValue>, std::less<>> Row;
 
 struct RecordSet
 {
@@ -33,11 +38,16 @@ struct RecordSet
     Row       m_old_row;
     RowVector m_row_vec;
     RowVector m_old_row_vec;
+    RowView   m_row_view;
+    RowView   m_old_row_view;
     RowType   row_type = RowType::Map;
 
     std::string tbl_name;
     std::string db_name;
 
+    // Names and types of the columns of the table
+    PtrSchema schema;
+
     time_t when;
 
     enum TypeEvent { Update, Delete, Write };
@@ -46,8 +56,33 @@ struct RecordSet
 
     // Root master ID from which this record originated
     unsigned int master_id = 0;
+
+    // Hash of key columns, if they are set for the table (see Slave::setKeyColumns()):
+    // of the new key if update changes it, otherwise of the old one.
+    uint64_t key_hash = 0;
+    bool     key_changed = false;
+    // Row image has not all key columns (i.e. binlog_row_image=MINIMAL and key columns are not
+    // the primary key), so key_hash is not the key: the row is ordered against all others.
+    bool     key_unknown = false;
+
+    // Copies strings, which refer to the event buffer in zero-copy mode (see
+    // Slave::setZeroCopyStrings()), into the values, so the RecordSet can be kept after the callback.
+    void materialize()
+    {
+        for (auto& i : m_row)
+            i.second.second.materialize();
+        for (auto& i : m_old_row)
+            i.second.second.materialize();
+        for (auto& i : m_row_vec)
+            i.second.materialize();
+        for (auto& i : m_old_row_vec)
+            i.second.materialize();
+    }
 };
 
+// All rows of one WRITE/UPDATE/DELETE_ROWS event, in order.
+typedef std::vector<RecordSet> RecordSetBatch;
+
 }// slave
 
 #endif
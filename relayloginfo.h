@@ -17,6 +17,7 @@
 
 #include "table.h"
 
+#include <array>
 #include <map>
 #include <memory>
 #include <string>
@@ -42,11 +43,28 @@ public:
     void clear() {
         m_map_table_name.clear();
         m_table_map.clear();
+        invalidateIdCache();
     }
 
 
     void setTableName(unsigned long table_id, const std::string& table_name, const std::string& db_name) {
         m_map_table_name[table_id] = std::make_pair(db_name, table_name);
+        IdCacheSlot& slot = m_id_cache[table_id % m_id_cache.size()];
+        slot.id = table_id;
+        slot.table = getTable(std::make_pair(db_name, table_name)).get();
+    }
+
+    // Table of the ROWS event: one cache slot check, names are looked up on a miss only.
+    // Null if the table is unknown or not replicated.
+    Table* getTableById(unsigned long table_id) const
+    {
+        IdCacheSlot& slot = m_id_cache[table_id % m_id_cache.size()];
+        if (slot.id != table_id) {
+            const auto p = m_map_table_name.find(table_id);
+            slot.id = table_id;
+            slot.table = p != m_map_table_name.end() ? getTable(p->second).get() : nullptr;
+        }
+        return slot.table;
     }
 
     const std::pair<std::string,std::string> getTableNameById(unsigned long table_id) const
@@ -74,8 +92,23 @@ public:
     void setTable(const std::string& table_name, const std::string& db_name, PtrTable&& table)
     {
         m_table_map[std::make_pair(db_name, table_name)] = std::move(table);
+        // The old table may be cached
+        invalidateIdCache();
     }
 
+private:
+
+    // Direct-mapped cache of table_id -> Table*. Table ids are given by the server one by one,
+    // so tables, which are used together, rarely collide.
+    struct IdCacheSlot
+    {
+        unsigned long id = -1;
+        Table* table = nullptr;
+    };
+    mutable std::array<IdCacheSlot, 256> m_id_cache;
+
+    void invalidateIdCache() { m_id_cache.fill(IdCacheSlot()); }
+
 };
 }
 #endif
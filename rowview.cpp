@@ -0,0 +1,53 @@
+#include <stdexcept>
+#include <utility>
+
+#include "rowview.h"
+#include "table.h"
+
+namespace slave
+{
+
+const std::string& RowView::getFieldName(unsigned i) const
+{
+    return m_table->fields.at(i)->getFieldName();
+}
+
+const std::string& RowView::getFieldType(unsigned i) const
+{
+    return m_table->fields.at(i)->field_type;
+}
+
+const char* RowView::value(unsigned i) const
+{
+    const Cell& c = cell(i);
+    if (c.state != Present)
+        throw std::runtime_error("RowView: field '" + getFieldName(i) + "' is " + (c.state == Null ? "NULL" : "absent in row image"));
+    return c.pos;
+}
+
+int64_t RowView::getInt64(unsigned i) const
+{
+    return m_table->fields[i]->get_int64(value(i));
+}
+
+double RowView::getDouble(unsigned i) const
+{
+    return m_table->fields[i]->get_double(value(i));
+}
+
+StringRef RowView::getStringRef(unsigned i) const
+{
+    return m_table->fields[i]->get_string_ref(value(i));
+}
+
+FieldValue RowView::getValue(unsigned i) const
+{
+    const Cell& c = cell(i);
+    if (c.state != Present)
+        return nullFieldValue();
+    const auto& field = m_table->fields[i];
+    field->unpack(c.pos);
+    return std::move(field->field_data);
+}
+
+}// slave
@@ -0,0 +1,64 @@
+#ifndef __SLAVE_ROWVIEW_H_
+#define __SLAVE_ROWVIEW_H_
+
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace slave
+{
+
+class Table;
+
+// One row in a table, as is in the binlog event buffer (RowType::View).
+// Nothing is unpacked until asked: typed getters decode value of the column
+// with given index in Table::fields. Column filter is not applied.
+// NOTE: view points into the event buffer, so it is valid only inside of the callback.
+class RowView
+{
+public:
+    enum CellState : unsigned char { Absent, Null, Present };
+
+    struct Cell
+    {
+        const char* pos;
+        CellState   state;
+    };
+
+    typedef std::vector<Cell> cells_t;
+
+    RowView() {}
+    RowView(const Table& table, const cells_t& cells) : m_table(&table), m_cells(&cells) {}
+
+    bool empty() const { return m_cells == nullptr; }
+    size_t size() const { return m_cells ? m_cells->size() : 0; }
+
+    // false if column is not in the row image (see binlog_row_image=minimal)
+    bool has(unsigned i) const { return cell(i).state != Absent; }
+    bool isNull(unsigned i) const { return cell(i).state == Null; }
+
+    const std::string& getFieldName(unsigned i) const;
+    const std::string& getFieldType(unsigned i) const;
+
+    // Integer types, YEAR, BIT, ENUM (index) and SET (bitmask)
+    int64_t getInt64(unsigned i) const;
+    uint64_t getUInt64(unsigned i) const { return static_cast<uint64_t>(getInt64(i)); }
+    // Integer types, FLOAT, DOUBLE and DECIMAL
+    double getDouble(unsigned i) const;
+    // CHAR, VARCHAR, TEXT, BLOB and ENUM
+    StringRef getStringRef(unsigned i) const;
+    // Any type, unpacked the same way as for RowType::Map and RowType::Vector
+    FieldValue getValue(unsigned i) const;
+
+private:
+    const Cell& cell(unsigned i) const { return m_cells->at(i); }
+    const char* value(unsigned i) const;
+
+    const Table*   m_table = nullptr;
+    const cells_t* m_cells = nullptr;
+};
+
+}// slave
+
+#endif
@@ -0,0 +1,21 @@
+#include <mutex>
+#include <unordered_set>
+
+#include "schema.h"
+
+namespace slave
+{
+
+SchemaString SchemaString::intern(const std::string& s)
+{
+    // Never freed: rows may be destroyed by static destructors of the user code.
+    // Elements of unordered_set do not move on rehash.
+    static std::mutex& mutex = *new std::mutex;
+    static std::unordered_set<std::string>& strings = *new std::unordered_set<std::string>;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::string& interned = *strings.insert(s).first;
+    return SchemaString(interned.data(), interned.size());
+}
+
+}// slave
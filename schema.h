@@ -0,0 +1,93 @@
+#ifndef __SLAVE_SCHEMA_H_
+#define __SLAVE_SCHEMA_H_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace slave
+{
+
+// Name or type of a column in Row and RowVector. Names and types of tables are interned: kept
+// once for the life of the process, so rows, which refer to them, stay valid after the table is
+// rebuilt on DDL and can be kept or moved anywhere. It compares and prints as a string.
+// SchemaString made of const char* refers to it: use it for string literals and lookups only,
+// keys stored in a row must come from intern() (i.e. from Schema).
+class SchemaString
+{
+public:
+    SchemaString() {}
+    SchemaString(const char* s) : m_data(s), m_size(std::strlen(s)) {}
+
+    // The same string, kept for the life of the process. Thread-safe.
+    static SchemaString intern(const std::string& s);
+
+    const char* data() const { return m_data; }
+    const char* c_str() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return !m_size; }
+
+    std::string str() const { return std::string(m_data, m_size); }
+    operator std::string() const { return str(); }
+
+    int compare(const char* data, size_t size) const
+    {
+        const int r = std::memcmp(m_data, data, std::min(m_size, size));
+        return r ? r : (m_size < size ? -1 : m_size > size);
+    }
+    int compare(const SchemaString& other) const { return compare(other.m_data, other.m_size); }
+    int compare(const std::string& other) const { return compare(other.data(), other.size()); }
+    int compare(const char* other) const { return compare(other, std::strlen(other)); }
+
+    friend bool operator==(const SchemaString& a, const SchemaString& b) { return a.m_size == b.m_size && !a.compare(b); }
+    friend bool operator==(const SchemaString& a, const std::string& b) { return a.m_size == b.size() && !a.compare(b); }
+    friend bool operator==(const std::string& a, const SchemaString& b) { return b == a; }
+    friend bool operator==(const SchemaString& a, const char* b) { return !a.compare(b); }
+    friend bool operator==(const char* a, const SchemaString& b) { return b == a; }
+    friend bool operator!=(const SchemaString& a, const SchemaString& b) { return !(a == b); }
+    friend bool operator!=(const SchemaString& a, const std::string& b) { return !(a == b); }
+    friend bool operator!=(const std::string& a, const SchemaString& b) { return !(a == b); }
+    friend bool operator!=(const SchemaString& a, const char* b) { return !(a == b); }
+    friend bool operator!=(const char* a, const SchemaString& b) { return !(a == b); }
+
+    // Row is ordered by std::less<>, so it can be searched by std::string without conversion
+    friend bool operator<(const SchemaString& a, const SchemaString& b) { return a.compare(b) < 0; }
+    friend bool operator<(const SchemaString& a, const std::string& b) { return a.compare(b) < 0; }
+    friend bool operator<(const std::string& a, const SchemaString& b) { return b.compare(a) > 0; }
+    friend bool operator<(const SchemaString& a, const char* b) { return a.compare(b) < 0; }
+    friend bool operator<(const char* a, const SchemaString& b) { return b.compare(a) > 0; }
+
+    friend std::ostream& operator<<(std::ostream& os, const SchemaString& s) { return os.write(s.m_data, s.m_size); }
+
+private:
+    SchemaString(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+    const char* m_data = "";
+    size_t      m_size = 0;
+};
+
+// Column names and types of a table, interned. It is built with the table and never changed
+// after that.
+struct Schema
+{
+    std::vector<SchemaString> names;
+    std::vector<SchemaString> types;
+
+    // Index of the column, -1 if there is no such column
+    int index(const std::string& name) const
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+            if (names[i] == name)
+                return i;
+        return -1;
+    }
+};
+
+typedef std::shared_ptr<const Schema> PtrSchema;
+
+}// slave
+
+#endif
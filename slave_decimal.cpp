@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "slave_decimal.h"
+
+namespace
+{
+
+const unsigned dig_per_dec = 9;
+const unsigned dig2bytes[dig_per_dec + 1] = {0, 1, 1, 2, 2, 3, 3, 4, 4, 4};
+const uint32_t powers10[dig_per_dec + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Big-endian group of digits, bytes are inverted for negative numbers
+inline uint32_t read_group(const unsigned char*& p, unsigned bytes, unsigned char mask)
+{
+    uint32_t value = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+        value = (value << 8) | (*p++ ^ mask);
+    return value;
+}
+
+template <typename T>
+T decode(const char* from, unsigned precision, unsigned scale, bool& negative)
+{
+    const unsigned intg = precision - scale;
+    const unsigned intg0 = intg / dig_per_dec, intg0x = intg % dig_per_dec;
+    const unsigned frac0 = scale / dig_per_dec, frac0x = scale % dig_per_dec;
+
+    // The first bit is inverted, see decimal2bin() @ decimal.c
+    unsigned char buf[32];
+    const unsigned size = (intg0 + frac0) * 4 + dig2bytes[intg0x] + dig2bytes[frac0x];
+    std::memcpy(buf, from, size);
+    buf[0] ^= 0x80;
+
+    negative = buf[0] & 0x80;
+    const unsigned char mask = negative ? 0xff : 0;
+    const unsigned char* p = buf;
+
+    T value = read_group(p, dig2bytes[intg0x], mask);
+    for (unsigned i = 0; i < intg0 + frac0; ++i)
+        value = value * powers10[dig_per_dec] + read_group(p, 4, mask);
+    if (frac0x)
+        value = value * powers10[frac0x] + read_group(p, dig2bytes[frac0x], mask);
+    return value;
+}
+
+}// anonymous-namespace
+
+namespace slave
+{
+
+unsigned Decimal::binarySize(unsigned precision, unsigned scale)
+{
+    const unsigned intg = precision - scale;
+    return (intg / dig_per_dec) * 4 + dig2bytes[intg % dig_per_dec] + (scale / dig_per_dec) * 4 + dig2bytes[scale % dig_per_dec];
+}
+
+Decimal Decimal::fromBinary(const char* from, unsigned precision, unsigned scale)
+{
+    bool negative;
+    __int128 value = precision <= 18
+        ? __int128(decode<int64_t>(from, precision, scale, negative))
+        : decode<__int128>(from, precision, scale, negative);
+    return Decimal(negative ? -value : value, precision, scale);
+}
+
+std::string Decimal::str() const
+{
+    // 39 digits of __int128, sign, point and leading zero
+    char buf[48];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+
+    unsigned __int128 abs = value < 0 ? -(unsigned __int128)value : value;
+    unsigned digits = 0;
+    do {
+        *--p = '0' + unsigned(abs % 10);
+        abs /= 10;
+        if (++digits == scale)
+            *--p = '.';
+    } while (abs || digits < scale);
+    if (digits == scale)
+        *--p = '0';
+    if (value < 0)
+        *--p = '-';
+    return std::string(p, end - p);
+}
+
+double Decimal::toDouble() const
+{
+    static const double scales[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    // Both are exact, so the quotient is correctly rounded
+    const __int128 max_exact = __int128(1) << 53;
+    if (value > -max_exact && value < max_exact && scale <= 22)
+        return double(int64_t(value)) / scales[scale];
+    return std::strtod(str().c_str(), nullptr);
+}
+
+}// slave
@@ -0,0 +1,42 @@
+#ifndef __SLAVE_DECIMAL_H_
+#define __SLAVE_DECIMAL_H_
+
+#include <cstdint>
+#include <string>
+
+namespace slave
+{
+
+// Typed DECIMAL value, which fields give instead of strings in typed decimal mode
+// (see Slave::setTypedDecimal()): unscaled integer with the precision and scale of the column,
+// i.e. 1234.5600 of DECIMAL(18,4) is {12345600, 18, 4}. It is decoded from the binlog image
+// directly; str() and toDouble() convert it, when it is needed.
+// Columns with precision greater than Decimal::max_precision are given as strings.
+struct Decimal
+{
+    static const unsigned max_precision = 38;
+
+    __int128 value = 0;
+    uint8_t  precision = 0;
+    uint8_t  scale = 0;
+
+    Decimal() {}
+    Decimal(__int128 value_, uint8_t precision_, uint8_t scale_) : value(value_), precision(precision_), scale(scale_) {}
+
+    // The same as decimal2string() gives: "-1234.5600"
+    std::string str() const;
+    // Correctly rounded
+    double toDouble() const;
+
+    // Unscaled value, if it fits (always does for precision up to 18)
+    bool fitsInt64() const { return value >= INT64_MIN && value <= INT64_MAX; }
+    int64_t unscaled() const { return int64_t(value); }
+
+    // Decodes the binary format of DECIMAL(precision, scale), see bin2decimal() @ decimal.c
+    static Decimal fromBinary(const char* from, unsigned precision, unsigned scale);
+    static unsigned binarySize(unsigned precision, unsigned scale);
+};
+
+}// slave
+
+#endif
@@ -24,8 +24,7 @@
 
 #include <mysql.h>
 
-#include <zlib.h>
-
+#include "crc32.h"
 #include "relayloginfo.h"
 #include "slave_log_event.h"
 
@@ -112,6 +111,22 @@ Query_event_info::Query_event_info(const char* buf, unsigned int event_len) {
 }
 
 
+void table_map_names(const char* buf, unsigned int event_len, std::pair<std::string, std::string>& names)
+{
+    const char* const end = buf + event_len;
+    const char* p = buf + LOG_EVENT_HEADER_LEN + TABLE_MAP_HEADER_LEN;
+    if (event_len < LOG_EVENT_HEADER_LEN + TABLE_MAP_HEADER_LEN + 2 || p + 1 + (unsigned char)*p + 2 > end) {
+        throw std::runtime_error("table_map_names() failed - event_len too small");
+    }
+    names.first.assign(p + 1, (unsigned char)*p);
+
+    p += 1 + (unsigned char)*p + 1;
+    if (p + 1 + (unsigned char)*p > end) {
+        throw std::runtime_error("table_map_names() failed - event_len too small");
+    }
+    names.second.assign(p + 1, (unsigned char)*p);
+}
+
 Table_map_event_info::Table_map_event_info(const char* buf, unsigned int event_len) {
 
     if (event_len < LOG_EVENT_HEADER_LEN + TABLE_MAP_HEADER_LEN + 2) {
@@ -142,6 +157,26 @@ Table_map_event_info::Table_map_event_info(const char* buf, unsigned int event_l
     m_metadata.assign(metadata, metadata + metadata_length);
 }
 
+// Fills indexes of the bits set in the column bitmap, one bit scan per present column
+const unsigned char* present_columns(const unsigned char* bitmap, unsigned long width, std::vector<unsigned>& present)
+{
+    const size_t bytes = (width + 7) / 8;
+    size_t count = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        count += __builtin_popcount(bitmap[i]);
+
+    present.clear();
+    present.reserve(count);
+    for (size_t i = 0; i < bytes; ++i) {
+        for (unsigned bits = bitmap[i]; bits; bits &= bits - 1) {
+            const unsigned index = i * 8 + __builtin_ctz(bits);
+            if (index < width)
+                present.push_back(index);
+        }
+    }
+    return bitmap + bytes;
+}
+
 Row_event_info::Row_event_info(const char* buf, const unsigned int event_len, const bool is_update, const bool is_v2_event)
 {
     unsigned header_len = is_v2_event ? ROWS_HEADER_LEN : ROWS_HEADER_LEN_V1;
@@ -171,13 +206,10 @@ Row_event_info::Row_event_info(const char* buf, const unsigned int event_len, co
     unsigned char* p_data = (unsigned char*)buf + LOG_EVENT_HEADER_LEN + header_len;
 
     m_width = net_field_length(&p_data);
-    m_cols.assign(p_data, p_data + (m_width + 7) / 8);
-    p_data += m_cols.size();
+    p_data = (unsigned char*)present_columns(p_data, m_width, m_present);
 
-    if (is_update) {
-        m_cols_ai.assign(p_data, p_data + m_cols.size());
-        p_data += m_cols_ai.size();
-    }
+    if (is_update)
+        p_data = (unsigned char*)present_columns(p_data, m_width, m_present_ai);
 
     m_rows_buf = p_data;
     m_rows_end = (unsigned char*)buf + event_len;
@@ -194,6 +226,72 @@ Gtid_event_info::Gtid_event_info(const char* buf, unsigned int event_len)
     m_gno = sint8korr(buf + LOG_EVENT_HEADER_LEN + ENCODED_FLAG_LENGTH + ENCODED_SID_LENGTH);
 }
 
+namespace
+{
+
+// Packed integer of the payload header, see net_store_length() @ pack.cc
+uint64_t read_packed(const unsigned char*& p, const unsigned char* end)
+{
+    const unsigned size = *p < 251 ? 1 : *p == 252 ? 3 : *p == 253 ? 4 : *p == 254 ? 9 : 0;
+    if (!size || p + size > end)
+        throw std::runtime_error("Transaction_payload_event_info::Transaction_payload_event_info failed - bad packed integer");
+
+    uint64_t value = size == 1 ? *p : 0;
+    for (unsigned i = size - 1; i > 0; --i)
+        value = (value << 8) | p[i];
+    p += size;
+    return value;
+}
+
+}// anonymous-namespace
+
+Transaction_payload_event_info::Transaction_payload_event_info(const char* buf, unsigned int event_len)
+{
+    // Fields of the header, see Transaction_payload_event @ control_events.h
+    enum { HeaderEndMark = 0, PayloadSize = 1, CompressionType = 2, UncompressedSize = 3 };
+
+    const unsigned char* p = (const unsigned char*)buf + LOG_EVENT_HEADER_LEN + TRANSACTION_PAYLOAD_HEADER_LEN;
+    const unsigned char* const end = (const unsigned char*)buf + event_len;
+    if (p > end) {
+        LOG_ERROR(log, "Sanity check failed: " << event_len << " " << LOG_EVENT_HEADER_LEN + TRANSACTION_PAYLOAD_HEADER_LEN);
+        throw std::runtime_error("Transaction_payload_event_info::Transaction_payload_event_info failed");
+    }
+
+    bool has_size = false;
+    while (p < end) {
+        const uint64_t type = read_packed(p, end);
+        if (type == HeaderEndMark)
+            break;
+        const uint64_t length = read_packed(p, end);
+        if (length > uint64_t(end - p))
+            throw std::runtime_error("Transaction_payload_event_info::Transaction_payload_event_info failed - field is out of the event");
+
+        const unsigned char* value = p;
+        switch (type) {
+        case PayloadSize:
+            m_payload_size = read_packed(value, p + length);
+            has_size = true;
+            break;
+        case CompressionType:
+            m_compression = read_packed(value, p + length);
+            break;
+        case UncompressedSize:
+            m_uncompressed_size = read_packed(value, p + length);
+            break;
+        default:
+            // Unknown fields are skipped, as the server does
+            break;
+        }
+        p += length;
+    }
+
+    if (!has_size || m_payload_size > uint64_t(end - p)) {
+        LOG_ERROR(log, "Sanity check failed: payload size " << m_payload_size << ", " << end - p << " bytes left");
+        throw std::runtime_error("Transaction_payload_event_info::Transaction_payload_event_info failed");
+    }
+    m_payload = (const char*)p;
+}
+
 /////////////////////////
 
 
@@ -244,7 +342,7 @@ inline void check_format_description(const char* buf, unsigned int event_len, bo
 
     unsigned char event_lens[LOG_EVENT_TYPES] = { 0, };
 
-    ::memcpy(&event_lens[0], (unsigned char*)(buf + ST_COMMON_HEADER_LEN_OFFSET + 1), LOG_EVENT_TYPES);
+    ::memcpy(&event_lens[0], (unsigned char*)(buf + ST_COMMON_HEADER_LEN_OFFSET + 1), number_of_event_types);
 
     check_format_description_postlen(event_lens, XID_EVENT, 0);
     check_format_description_postlen(event_lens, QUERY_EVENT, QUERY_HEADER_LEN);
@@ -264,13 +362,7 @@ inline void check_format_description(const char* buf, unsigned int event_len, bo
 }
 
 
-inline uint32_t checksum_crc32(uint32_t crc, const unsigned char* pos, size_t length)
-{
-    return static_cast<uint32_t>(::crc32(static_cast<unsigned int>(crc), pos, static_cast<unsigned int>(length)));
-}
-
-
-bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, EventStatIface* event_stat, bool master_ge_56, MasterInfo& master_info)
+bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, EventStatIface* event_stat, bool master_ge_56, MasterInfo& master_info, bool with_checksum)
 
 {
 
@@ -294,7 +386,7 @@ bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, Even
             master_info.checksum_alg = alg;
     }
 
-    if (master_info.checksumEnabled())
+    if (master_info.checksumEnabled() && with_checksum)
     {
         uint32_t incoming;
         ::memcpy(&incoming, buf + event_len - BINLOG_CHECKSUM_LEN, sizeof(incoming));
@@ -355,6 +447,12 @@ bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, Even
         break;
     case GTID_LOG_EVENT:
         return true;
+    case HEARTBEAT_LOG_EVENT:
+        // Is not counted by tick(), see above
+        return true;
+    case TRANSACTION_PAYLOAD_EVENT:
+        // Its events are unpacked and read by the caller
+        return true;
     case LOAD_EVENT:
     case NEW_LOAD_EVENT:
     case SLAVE_EVENT: /* can never happen (unused event) */
@@ -373,7 +471,6 @@ bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, Even
     case BEGIN_LOAD_QUERY_EVENT:
     case EXECUTE_LOAD_QUERY_EVENT:
     case INCIDENT_EVENT:
-    case HEARTBEAT_LOG_EVENT:
     case IGNORABLE_LOG_EVENT:
     case ROWS_QUERY_LOG_EVENT:
     case ANONYMOUS_GTID_LOG_EVENT:
@@ -381,6 +478,8 @@ bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, Even
     case TRANSACTION_CONTEXT_EVENT:
     case VIEW_CHANGE_EVENT:
     case XA_PREPARE_LOG_EVENT:
+    case PARTIAL_UPDATE_ROWS_EVENT:
+    case HEARTBEAT_LOG_EVENT_V2:
         if (event_stat)
             event_stat->tickOther();
         return false;
@@ -411,38 +510,100 @@ bool read_log_event(const char* buf, uint event_len, Basic_event_info& bei, Even
  */
 
 
-size_t n_set_bits(const std::vector<unsigned char>& b, unsigned int count) {
-
-    size_t ret = 0;
+// Values are taken by value: freshly decoded ones are moved into the row without a copy.
+template <typename T>
+void fill_row(const slave::Table& table, T& row, unsigned index, slave::FieldValue value);
 
-    for (unsigned int i = 0; i < count; ++i) {
+template <>
+void fill_row<slave::Row>(const slave::Table& table, slave::Row& row, unsigned index, slave::FieldValue value)
+{
+    const slave::Schema& schema = *table.schema;
+    if (table.column_filter.empty() || table.column_filter[index / 8] & (1 << (index & 7)))
+        row[schema.names[index]] = std::make_pair(slave::SchemaString(schema.types[index]), std::move(value));
+}
 
-        if (b[i / 8] & (1 << (i & 7)))
-            ret++;
-    }
+template <>
+void fill_row<slave::RowVector>(const slave::Table& table, slave::RowVector& row, unsigned index, slave::FieldValue value)
+{
+    const slave::SchemaString type = table.schema->types[index];
+    if (table.column_filter.empty())
+        row.emplace_back(type, std::move(value));
+    else if (table.column_filter[index / 8] & (1 << (index & 7)))
+        row[table.column_filter_fields[index]] = std::make_pair(type, std::move(value));
+}
 
-    return ret;
+template <>
+void fill_row<slave::RowView::cells_t>(const slave::Table& table, slave::RowView::cells_t& row, unsigned index, slave::FieldValue value)
+{
+    // Only NULL values get here, see unpack_field()
+    row[index].state = slave::RowView::Null;
 }
 
+// Runs the step of the table decode plan: fixed-size numbers are decoded here into the same types,
+// as Field_num::unpack() gives, without virtual call and without field_data. Strings and blobs are
+// copied straight from the event, or referred to in zero-copy mode.
 template <typename T>
-void fill_row(const slave::Table& table, T& row, unsigned index, const slave::FieldValue& value);
+unsigned char* unpack_field(const slave::Table& table, T& row, unsigned index, unsigned char* ptr)
+{
+    const slave::DecodeOp& op = table.decode_plan[index];
+    const char* from = (const char*)ptr;
+
+    switch (op.kind) {
+    case slave::DecodeOp::UInt8:  fill_row<T>(table, row, index, uint16(*(const uchar*)from)); break;
+    case slave::DecodeOp::UInt16: fill_row<T>(table, row, index, uint16(uint2korr(from))); break;
+    case slave::DecodeOp::UInt24: fill_row<T>(table, row, index, uint32(uint3korr(from))); break;
+    case slave::DecodeOp::UInt32: fill_row<T>(table, row, index, uint32(uint4korr(from))); break;
+    case slave::DecodeOp::UInt64: fill_row<T>(table, row, index, ulonglong(uint8korr(from))); break;
+    case slave::DecodeOp::Int8:   fill_row<T>(table, row, index, int16(*from)); break;
+    case slave::DecodeOp::Int16:  fill_row<T>(table, row, index, int16(sint2korr(from))); break;
+    case slave::DecodeOp::Int24:  fill_row<T>(table, row, index, int32(sint3korr(from))); break;
+    case slave::DecodeOp::Int32:  fill_row<T>(table, row, index, int32(sint4korr(from))); break;
+    case slave::DecodeOp::Int64:  fill_row<T>(table, row, index, longlong(sint8korr(from))); break;
+    case slave::DecodeOp::Float:  fill_row<T>(table, row, index, *(const float*)from); break;
+    case slave::DecodeOp::Double: fill_row<T>(table, row, index, *(const double*)from); break;
+    case slave::DecodeOp::String: {
+        const slave::StringRef ref = op.field->get_string_ref(from);
+        fill_row<T>(table, row, index, table.zero_copy_strings ? slave::FieldValue::reference(ref) : slave::FieldValue(ref.data, ref.size));
+        return (unsigned char*)(ref.data + ref.size);
+    }
+    default:
+        ptr = (unsigned char*)op.field->unpack(from);
+        // field_data is only the output of unpack(), so long strings are moved, not copied
+        fill_row<T>(table, row, index, std::move(op.field->field_data));
+        return ptr;
+    }
+    return ptr + op.length;
+}
+
+// Steps over the value without decoding it: fixed-size values by the length from the plan,
+// others by their length prefix
+inline unsigned char* skip_field(const slave::Table& table, unsigned index, unsigned char* ptr)
+{
+    const slave::DecodeOp& op = table.decode_plan[index];
+    return ptr + (op.length ? op.length : op.field->pack_length((const char*)ptr));
+}
 
 template <>
-void fill_row<slave::Row>(const slave::Table& table, slave::Row& row, unsigned index, const slave::FieldValue& value)
+unsigned char* unpack_field<slave::RowView::cells_t>(const slave::Table& table, slave::RowView::cells_t& row, unsigned index, unsigned char* ptr)
 {
-    const auto& field = table.fields[index];
-    if (table.column_filter.empty() || table.column_filter[index / 8] & (1 << (index & 7)))
-        row[field->getFieldName()] = std::make_pair(field->field_type, value);
+    // Do not unpack anything, just remember where the value is
+    row[index].pos = (const char*)ptr;
+    row[index].state = slave::RowView::Present;
+    return skip_field(table, index, ptr);
+}
+
+// Columns, which are not in the column filter, are skipped instead of being decoded
+template <typename T>
+bool is_filtered_out(const slave::Table& table, unsigned index)
+{
+    return !table.column_filter.empty() && !(table.column_filter[index / 8] & (1 << (index & 7)));
 }
 
 template <>
-void fill_row<slave::RowVector>(const slave::Table& table, slave::RowVector& row, unsigned index, const slave::FieldValue& value)
+bool is_filtered_out<slave::RowView::cells_t>(const slave::Table& table, unsigned index)
 {
-    const auto& field = table.fields[index];
-    if (table.column_filter.empty())
-        row.emplace_back(field->field_type, value);
-    else if (table.column_filter[index / 8] & (1 << (index & 7)))
-        row[table.column_filter_fields[index]] = std::make_pair(field->field_type, value);
+    // Views give all the columns
+    return false;
 }
 
 template <typename T>
@@ -457,16 +618,45 @@ void reserve_row<slave::RowVector>(const slave::Table& table, slave::RowVector&
         row.resize(table.column_filter_count);
 }
 
+template <>
+void reserve_row<slave::RowView::cells_t>(const slave::Table& table, slave::RowView::cells_t& row)
+{
+    row.assign(table.fields.size(), slave::RowView::Cell{nullptr, slave::RowView::Absent});
+}
+
+// FNV-1a of raw (packed) values of key columns
+struct KeyHash
+{
+    uint64_t value = 14695981039346656037ULL;
+    unsigned columns = 0;
+
+    void add(const unsigned char* from, const unsigned char* to)
+    {
+        for (; from < to; ++from)
+            mix(*from);
+        // Column separator, also stands for NULL value
+        mix(0xFF);
+        ++columns;
+    }
+
+    void mix(unsigned char c)
+    {
+        value ^= c;
+        value *= 1099511628211ULL;
+    }
+};
+
 template <typename T>
 unsigned char* unpack_row(const slave::Table& table,
                           T& _row,
                           unsigned int colcnt,
                           unsigned char* row,
-                          const std::vector<unsigned char>& cols)
+                          const std::vector<unsigned>& present,
+                          KeyHash* key = nullptr)
 {
 
     LOG_TRACE(log, "Unpacking row: " << "fields in the table " << table.fields.size() << ", fields in the event " << colcnt
-             << ", bitfield width " << cols.size());
+             << ", present fields " << present.size());
 
     if (colcnt != table.fields.size()) {
         LOG_ERROR(log, "Field count mismatch in unpacking row for "
@@ -474,38 +664,28 @@ unsigned char* unpack_row(const slave::Table& table,
         throw std::runtime_error("unpack_row failed");
     }
 
+    if (table.decode_plan.size() != colcnt) {
+        LOG_ERROR(log, "Decode plan of " << table.full_name << " is not compiled");
+        throw std::runtime_error("unpack_row failed");
+    }
 
-    // pointer to start of data; skip master_null_bytes
-
-    size_t master_null_byte_count = (n_set_bits(cols, colcnt) + 7) / 8;
-
-    unsigned char* ptr = row + master_null_byte_count;
+    // Null bitmap has a bit per present column, data follows it
+    const unsigned char* const null_bits = row;
+    const size_t null_bytes = (present.size() + 7) / 8;
+    unsigned char* ptr = row + null_bytes;
 
-    //
-    unsigned char* null_ptr = row;
-    unsigned int null_mask = 1U;
-    unsigned char null_bits = *null_ptr++;
+    // Rows without NULLs do not look at the bitmap any more
+    bool has_nulls = false;
+    for (size_t i = 0; i < null_bytes && !has_nulls; ++i)
+        has_nulls = null_bits[i];
 
     reserve_row<T>(table, _row);
 
-    for (unsigned i = 0; i < colcnt; i++)
+    for (size_t n = 0; n < present.size(); ++n)
     {
-        const auto& field = table.fields[i];
+        const unsigned i = present[n];
 
-        if (!cols.empty() && !(cols[i / 8] & (1 << (i & 7)))) {
-
-            LOG_TRACE(log, "field " << field->getFieldName() << " is not in column list.");
-            continue;
-        }
-
-        if ((null_mask & 0xFF) == 0) {
-            null_mask = 1U;
-            null_bits = *null_ptr++;
-
-            LOG_TRACE(log, "null mask reset.");
-        }
-
-        if (null_bits & null_mask) {
+        if (has_nulls && (null_bits[n / 8] & (1 << (n & 7)))) {
 
             LOG_TRACE(log, "field with NULL value found");
 
@@ -514,17 +694,24 @@ unsigned char* unpack_row(const slave::Table& table,
             // in order to indicate presence of NULL value.
 
             fill_row<T>(table, _row, i, nullFieldValue());
+
+            if (key && table.is_key_column(i))
+                key->add(ptr, ptr);
         }
         else
         {
             // We unpack the field to some certain value if it was NOT NULL
-            ptr = (unsigned char*)field->unpack((const char*)ptr);
-            fill_row<T>(table, _row, i, field->field_data);
+            unsigned char* const start = ptr;
+            if (is_filtered_out<T>(table, i))
+                ptr = skip_field(table, i, ptr);
+            else
+                ptr = unpack_field<T>(table, _row, i, ptr);
+
+            if (key && table.is_key_column(i))
+                key->add(start, ptr);
         }
 
-        null_mask <<= 1;
-
-        LOG_TRACE(log, "field: " << field->getFieldName());
+        LOG_TRACE(log, "field: " << table.fields[i]->getFieldName());
 
     }
 
@@ -532,33 +719,65 @@ unsigned char* unpack_row(const slave::Table& table,
 }
 
 
+// Tells, if the row image had all key columns of the table, and reports it once, if not
+bool key_complete(const slave::Table& table, const KeyHash& key)
+{
+    if (key.columns == table.key_columns_count)
+        return true;
+    if (!table.key_missing_reported) {
+        table.key_missing_reported = true;
+        LOG_WARNING(log, "Row image of " << table.full_name << " has " << key.columns << " of " << table.key_columns_count
+                    << " key columns (binlog_row_image=MINIMAL?), such rows are ordered against all others");
+    }
+    return false;
+}
+
+// Prepares the pooled RecordSet for the next row: values of the previous one are dropped,
+// but vectors keep their capacity.
+void recycle_record_set(slave::RecordSet& rs)
+{
+    rs.m_row.clear();
+    rs.m_old_row.clear();
+    rs.m_row_vec.clear();
+    rs.m_old_row_vec.clear();
+}
+
 unsigned char* do_writedelete_row(const slave::Table& table,
                                   const Basic_event_info& bei,
                                   const Row_event_info& roi,
                                   unsigned char* row_start,
-                                  ExtStateIface &ext_state) {
+                                  slave::RecordSet& _record_set,
+                                  RowView::cells_t& cells) {
 
-    slave::RecordSet _record_set;
+    KeyHash key;
+    KeyHash* const pkey = table.key_columns.empty() ? nullptr : &key;
 
     unsigned char* t = nullptr;
     if (table.row_type == RowType::Map)
-        t = unpack_row(table, _record_set.m_row, roi.m_width, row_start, roi.m_cols);
-    else
-        t = unpack_row(table, _record_set.m_row_vec, roi.m_width, row_start, roi.m_cols);
+        t = unpack_row(table, _record_set.m_row, roi.m_width, row_start, roi.m_present, pkey);
+    else if (table.row_type == RowType::Vector)
+        t = unpack_row(table, _record_set.m_row_vec, roi.m_width, row_start, roi.m_present, pkey);
+    else {
+        t = unpack_row(table, cells, roi.m_width, row_start, roi.m_present, pkey);
+        _record_set.m_row_view = RowView(table, cells);
+    }
 
     if (t == NULL) {
         return NULL;
     }
 
+    _record_set.key_hash = key.value;
+    _record_set.key_changed = false;
+    _record_set.key_unknown = pkey && !key_complete(table, key);
     _record_set.row_type = table.row_type;
     _record_set.when = bei.when;
     _record_set.tbl_name = table.table_name;
     _record_set.db_name = table.database_name;
+    if (_record_set.schema != table.schema)
+        _record_set.schema = table.schema;
     _record_set.type_event = (bei.type == WRITE_ROWS_EVENT_V1 || bei.type == WRITE_ROWS_EVENT ? slave::RecordSet::Write : slave::RecordSet::Delete);
     _record_set.master_id = bei.server_id;
 
-    table.call_callback(_record_set, ext_state);
-
     return t;
 }
 
@@ -566,41 +785,109 @@ unsigned char* do_update_row(const slave::Table& table,
                              const Basic_event_info& bei,
                              const Row_event_info& roi,
                              unsigned char* row_start,
-                             ExtStateIface &ext_state) {
+                             slave::RecordSet& _record_set,
+                             RowView::cells_t& cells,
+                             RowView::cells_t& old_cells) {
 
-    slave::RecordSet _record_set;
+    KeyHash old_key, key;
+    const bool has_key = !table.key_columns.empty();
 
     unsigned char* t = nullptr;
     if (table.row_type == RowType::Map)
-        t = unpack_row(table, _record_set.m_old_row, roi.m_width, row_start, roi.m_cols);
-    else
-        t = unpack_row(table, _record_set.m_old_row_vec, roi.m_width, row_start, roi.m_cols);
+        t = unpack_row(table, _record_set.m_old_row, roi.m_width, row_start, roi.m_present, has_key ? &old_key : nullptr);
+    else if (table.row_type == RowType::Vector)
+        t = unpack_row(table, _record_set.m_old_row_vec, roi.m_width, row_start, roi.m_present, has_key ? &old_key : nullptr);
+    else {
+        t = unpack_row(table, old_cells, roi.m_width, row_start, roi.m_present, has_key ? &old_key : nullptr);
+        _record_set.m_old_row_view = RowView(table, old_cells);
+    }
 
     if (t == NULL) {
         return NULL;
     }
 
     if (table.row_type == RowType::Map)
-        t = unpack_row(table, _record_set.m_row, roi.m_width, t, roi.m_cols_ai);
-    else
-        t = unpack_row(table, _record_set.m_row_vec, roi.m_width, t, roi.m_cols_ai);
+        t = unpack_row(table, _record_set.m_row, roi.m_width, t, roi.m_present_ai, has_key ? &key : nullptr);
+    else if (table.row_type == RowType::Vector)
+        t = unpack_row(table, _record_set.m_row_vec, roi.m_width, t, roi.m_present_ai, has_key ? &key : nullptr);
+    else {
+        t = unpack_row(table, cells, roi.m_width, t, roi.m_present_ai, has_key ? &key : nullptr);
+        _record_set.m_row_view = RowView(table, cells);
+    }
 
     if (t == NULL) {
         return NULL;
     }
 
+    // With minimal row image after image has key columns only if they are changed, and before
+    // image may have no key columns at all, if they are not the primary key
+    const bool old_complete = has_key && key_complete(table, old_key);
+    const bool new_complete = has_key && key.columns == table.key_columns_count;
+    _record_set.key_changed = new_complete && (!old_complete || key.value != old_key.value);
+    _record_set.key_hash = _record_set.key_changed ? key.value : old_key.value;
+    _record_set.key_unknown = has_key && !old_complete && !new_complete;
     _record_set.row_type = table.row_type;
     _record_set.when = bei.when;
     _record_set.tbl_name = table.table_name;
     _record_set.db_name = table.database_name;
+    if (_record_set.schema != table.schema)
+        _record_set.schema = table.schema;
     _record_set.type_event = slave::RecordSet::Update;
     _record_set.master_id = bei.server_id;
 
-    table.call_callback(_record_set, ext_state);
-
     return t;
 }
 
+// Unpacks all rows of the event into table.batch and calls batch callback once.
+// Returns number of rows.
+size_t do_batch(const slave::Table& table,
+                const Basic_event_info& bei,
+                const Row_event_info& roi,
+                bool is_update,
+                ExtStateIface &ext_state) {
+
+    auto& batch = table.batch;
+    auto& cells = table.batch_view_cells;
+    // In pooled mode rows of the previous batch are reused, the rest are dropped at the end
+    size_t n = 0;
+    if (!table.reuse_record_sets)
+        batch.clear();
+
+    unsigned char* row_start = roi.m_rows_buf;
+    while (row_start < roi.m_rows_end &&
+           row_start != NULL) {
+        if (n < batch.size())
+            recycle_record_set(batch[n]);
+        else
+            batch.emplace_back();
+        ++n;
+
+        // Every view in the batch needs its own cells
+        RowView::cells_t* row_cells = &table.view_cells;
+        RowView::cells_t* old_row_cells = &table.old_view_cells;
+        if (table.row_type == RowType::View) {
+            if (cells.size() < 2 * n)
+                cells.resize(2 * n);
+            row_cells = &cells[2 * n - 2];
+            old_row_cells = &cells[2 * n - 1];
+        }
+
+        if (is_update)
+            row_start = do_update_row(table, bei, roi, row_start, batch[n - 1], *row_cells, *old_row_cells);
+        else
+            row_start = do_writedelete_row(table, bei, roi, row_start, batch[n - 1], *row_cells);
+
+        if (row_start == NULL)
+            --n;
+    }
+    batch.resize(n);
+
+    if (!batch.empty())
+        table.call_batch_callback(batch, ext_state);
+
+    return batch.size();
+}
+
 namespace // anonymous
 {
     inline EventKind eventKind(Log_event_type type)
@@ -629,13 +916,34 @@ namespace // anonymous
 } // namespace anonymous
 
 
+bool skip_row_event(const slave::RelayLogInfo& rli, const Basic_event_info& bei, EventStatIface* event_stat) {
+    if (bei.event_len < LOG_EVENT_HEADER_LEN + ROWS_MAPID_OFFSET + 6)
+        return false; // Row_event_info will complain
+
+    const unsigned long table_id = uint6korr(bei.buf + LOG_EVENT_HEADER_LEN + ROWS_MAPID_OFFSET);
+    const slave::Table* table = rli.getTableById(table_id);
+    const EventKind kind = eventKind(bei.type);
+
+    if (!table) {
+        if (event_stat)
+            event_stat->tickModifyEventIgnored(table_id, kind);
+        return true;
+    }
+    if (!should_process(table->m_filter, kind)) {
+        if (event_stat) {
+            event_stat->tickModifyEventFiltered(table_id, kind);
+            event_stat->tickModifyEventIgnored(table_id, kind);
+        }
+        return true;
+    }
+    return false;
+}
+
 void apply_row_event(const slave::RelayLogInfo& rli, const Basic_event_info& bei, const Row_event_info& roi, ExtStateIface& ext_state, EventStatIface* event_stat) {
     EventKind kind = eventKind(bei.type);
-    std::pair<std::string,std::string> key = rli.getTableNameById(roi.m_table_id);
-
-    LOG_DEBUG(log, "applyRowEvent(): " << roi.m_table_id << " " << key.first << "." << key.second);
+    const slave::Table* table = rli.getTableById(roi.m_table_id);
 
-    const auto& table = rli.getTable(key);
+    LOG_DEBUG(log, "applyRowEvent(): " << roi.m_table_id << " " << (table ? table->full_name : std::string()));
 
     if (table) {
 
@@ -644,19 +952,47 @@ void apply_row_event(const slave::RelayLogInfo& rli, const Basic_event_info& bei
 
         unsigned char* row_start = roi.m_rows_buf;
 
-        if (should_process(table->m_filter, kind)) {
+        if (should_process(table->m_filter, kind) && table->m_batch_callback) {
+            time_stamp start = now();
+            size_t rows = 0;
+            try
+            {
+                rows = do_batch(*table, bei, roi, kind == eUpdate, ext_state);
+            }
+            catch (...)
+            {
+                if (event_stat)
+                    event_stat->tickModifyEventFailed(roi.m_table_id, kind);
+                throw;
+            }
+            if (event_stat && rows)
+                event_stat->tickModifyRowsDone(roi.m_table_id, kind, rows, now() - start);
+
+            if (event_stat)
+                event_stat->tickModifyEventDone(roi.m_table_id, kind);
+            return;
+        }
+        else if (should_process(table->m_filter, kind)) {
             while (row_start < roi.m_rows_end &&
                    row_start != NULL) {
                 time_stamp start = now();
                 try
                 {
+                    slave::RecordSet fresh_record_set;
+                    slave::RecordSet& _record_set = table->reuse_record_sets ? table->record_set : fresh_record_set;
+                    if (table->reuse_record_sets)
+                        recycle_record_set(_record_set);
+
                     if (kind == eUpdate) {
 
-                        row_start = do_update_row(*table, bei, roi, row_start, ext_state);
+                        row_start = do_update_row(*table, bei, roi, row_start, _record_set, table->view_cells, table->old_view_cells);
 
                     } else {
-                        row_start = do_writedelete_row(*table, bei, roi, row_start, ext_state);
+                        row_start = do_writedelete_row(*table, bei, roi, row_start, _record_set, table->view_cells);
                     }
+
+                    if (row_start != NULL)
+                        table->call_callback(_record_set, ext_state);
                 }
                 catch (...)
                 {
@@ -87,6 +87,14 @@ enum Log_event_type
 
   XA_PREPARE_LOG_EVENT= 38,
 
+  // 8.0 new events
+
+  PARTIAL_UPDATE_ROWS_EVENT = 39,
+
+  TRANSACTION_PAYLOAD_EVENT = 40,
+
+  HEARTBEAT_LOG_EVENT_V2 = 41,
+
   ENUM_END_EVENT
 };
 
@@ -131,6 +139,8 @@ enum Temporal_type
 #define ENCODED_GNO_LENGTH  8
 #define GTID_EVENT_LEN      (ENCODED_FLAG_LENGTH + ENCODED_SID_LENGTH + ENCODED_GNO_LENGTH)
 
+#define TRANSACTION_PAYLOAD_HEADER_LEN 0
+
 #define LOG_EVENT_MINIMAL_HEADER_LEN 19
 
 #define ST_BINLOG_VER_LEN           2
@@ -197,8 +207,10 @@ struct Row_event_info {
     unsigned long m_width;
     unsigned long m_table_id;
 
-    std::vector<unsigned char> m_cols;
-    std::vector<unsigned char> m_cols_ai;
+    // Indexes of the columns, which are present in the row images (before and after image
+    // for updates), computed once per event from the column bitmaps
+    std::vector<unsigned> m_present;
+    std::vector<unsigned> m_present_ai;
 
     unsigned char* m_rows_buf;
     unsigned char* m_rows_end;
@@ -216,11 +228,36 @@ struct Gtid_event_info
     Gtid_event_info(const char* buf, unsigned int event_len);
 };
 
+// Header of TRANSACTION_PAYLOAD_EVENT: events of a transaction, compressed as a whole
+// (binlog_transaction_compression of MySQL 8.0.20+). See PayloadReader to unpack them.
+struct Transaction_payload_event_info
+{
+    enum Compression { Zstd = 0, None = 255 };
+
+    uint64_t    m_compression = None;
+    uint64_t    m_uncompressed_size = 0;    // 0 if not given
+    const char* m_payload = nullptr;        // points into the event
+    uint64_t    m_payload_size = 0;
+
+    Transaction_payload_event_info(const char* buf, unsigned int event_len);
+};
+
 
-bool read_log_event(const char* buf, unsigned int event_len, Basic_event_info& info, EventStatIface* event_stat, bool master_ge_56, MasterInfo& master_info);
+// Events unpacked from TRANSACTION_PAYLOAD_EVENT have no checksum (with_checksum = false)
+bool read_log_event(const char* buf, unsigned int event_len, Basic_event_info& info, EventStatIface* event_stat, bool master_ge_56, MasterInfo& master_info,
+                    bool with_checksum = true);
 
 void apply_row_event(const slave::RelayLogInfo& rli, const Basic_event_info& bei, const Row_event_info& roi, ExtStateIface& ext_state, EventStatIface* event_stat);
 
+// Drops ROWS event of a table, which is not replicated or whose filter does not take the kind
+// of the event, by the table id from the post-header, before Row_event_info is built.
+// Updates the stats the same way apply_row_event() does. Returns true if the event is dropped.
+bool skip_row_event(const slave::RelayLogInfo& rli, const Basic_event_info& bei, EventStatIface* event_stat);
+
+// Database and table names of TABLE_MAP event, without parsing the rest of it. The strings are
+// assigned, so they keep their buffers from event to event.
+void table_map_names(const char* buf, unsigned int event_len, std::pair<std::string, std::string>& names);
+
 
 //------------------------------------------------------------------------------------------
 
@@ -0,0 +1,26 @@
+// Kept apart from event_source.cpp: linux/tcp.h, which has tcpi_bytes_received, conflicts
+// with netinet/tcp.h, which mysql headers may bring.
+#ifdef __linux__
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include "event_source.h"
+
+namespace slave
+{
+
+uint64_t socket_received_bytes(int fd)
+{
+#ifdef __linux__
+    tcp_info info;
+    socklen_t len = sizeof(info);
+    if (fd >= 0 && ::getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0
+     && len >= offsetof(tcp_info, tcpi_bytes_received) + sizeof(info.tcpi_bytes_received))
+        return info.tcpi_bytes_received;
+#endif
+    return 0;
+}
+
+}// slave
@@ -16,11 +16,13 @@
 #define __SLAVE_TABLE_H_
 
 
+#include <deque>
 #include <functional>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
+#include <stdexcept>
 
 #include "field.h"
 #include "recordset.h"
@@ -32,24 +34,105 @@ namespace slave
 
 typedef std::unique_ptr<Field> PtrField;
 typedef std::function<void (RecordSet&)> callback;
+typedef std::function<void (RecordSetBatch&)> batch_callback;
 typedef std::function<void (const std::string&, const std::string&, const std::vector<PtrField>&)> ddl_callback;
 typedef EventKind filter;
 
 
 inline bool should_process(EventKind filter, EventKind kind) { return (filter & kind) == kind; }
 
+class Table;
+
+// Takes rows of a table instead of its callbacks, e.g. for buffering them until commit.
+struct RecordSink
+{
+    virtual void push(const Table& table, RecordSet& rs) = 0;
+    // For tables with batch callback
+    virtual void pushBatch(const Table& table, RecordSetBatch& batch)
+    {
+        for (auto& rs : batch)
+            push(table, rs);
+    }
+    virtual ~RecordSink() {}
+};
+
 class Table {
 
 public:
 
     std::vector<PtrField> fields;
+    // One step per field, see compile_decode_plan()
+    std::vector<DecodeOp> decode_plan;
+    // Names and types of the fields, rows refer to them
+    PtrSchema schema;
     std::vector<unsigned char> column_filter;
     std::vector<unsigned> column_filter_fields;
     unsigned column_filter_count;
     RowType  row_type;
+    // String and blob values refer to the event buffer, see Slave::setZeroCopyStrings()
+    bool     zero_copy_strings = false;
+    // Pooled RecordSet mode, see Slave::setReuseRecordSets()
+    bool     reuse_record_sets = false;
+    mutable RecordSet record_set;
+
+    // Reusable buffers for RowType::View rows: views of a row image refer to them.
+    mutable RowView::cells_t view_cells;
+    mutable RowView::cells_t old_view_cells;
+
+    // Reusable buffers for batches. Deque, since views refer to its elements while it grows.
+    // Rows of the batch are kept between events only if reuse_record_sets is set.
+    mutable RecordSetBatch batch;
+    mutable std::deque<RowView::cells_t> batch_view_cells;
 
     callback m_callback;
+    batch_callback m_batch_callback;
     EventKind m_filter;
+    // If set, rows go here and callbacks are not called
+    RecordSink* m_sink = nullptr;
+    // Worker thread for the table's callbacks, see Slave::enableWorkers()
+    unsigned m_worker = 0;
+    // Bitmask of key columns: if set, rows are spread over workers by hash of the key
+    std::vector<unsigned char> key_columns;
+    unsigned key_columns_count = 0;
+    // Row image without some key columns was met and reported, used by the decoder only
+    mutable bool key_missing_reported = false;
+
+    bool is_key_column(unsigned index) const
+    {
+        return !key_columns.empty() && (key_columns[index / 8] & (1 << (index & 7)));
+    }
+
+    void set_key_columns(const std::vector<unsigned>& _key_columns)
+    {
+        key_columns.clear();
+        key_columns_count = 0;
+        if (_key_columns.empty())
+            return;
+
+        key_columns.resize((fields.size() + 7) / 8);
+        for (const unsigned index : _key_columns) {
+            if (index >= fields.size())
+                throw std::runtime_error("Table::set_key_columns(): no column " + std::to_string(index) + " in " + full_name);
+            if (!is_key_column(index))
+                ++key_columns_count;
+            key_columns[index / 8] |= (1 << (index & 7));
+        }
+    }
+
+    // Must be called when fields are set: the decoder runs the plan, not the fields,
+    // and rows get names and types from the schema.
+    void compile_decode_plan()
+    {
+        std::shared_ptr<Schema> s(new Schema);
+        decode_plan.clear();
+        decode_plan.reserve(fields.size());
+        for (const auto& field : fields) {
+            decode_plan.push_back(field->decode_op());
+            s->names.push_back(SchemaString::intern(field->field_name));
+            s->types.push_back(SchemaString::intern(field->field_type));
+        }
+        schema = std::move(s);
+    }
 
     void call_callback(slave::RecordSet& _rs, ExtStateIface &ext_state) const
     {
@@ -57,7 +140,22 @@ public:
         ext_state.incTableCount(full_name);
         ext_state.setLastFilteredUpdateTime();
 
-        m_callback(_rs);
+        if (m_sink)
+            m_sink->push(*this, _rs);
+        else
+            m_callback(_rs);
+    }
+
+    void call_batch_callback(slave::RecordSetBatch& _batch, ExtStateIface &ext_state) const
+    {
+        // Stats are updated once per batch
+        ext_state.addTableCount(full_name, _batch.size());
+        ext_state.setLastFilteredUpdateTime();
+
+        if (m_sink)
+            m_sink->pushBatch(*this, _batch);
+        else
+            m_batch_callback(_batch);
     }
 
     void set_column_filter(const std::vector<std::string> &_column_filter) {
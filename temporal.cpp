@@ -0,0 +1,167 @@
+#include <algorithm>
+
+#include "temporal.h"
+#include "timezone.h"
+
+namespace
+{
+
+char* put(char* p, unsigned value, unsigned digits)
+{
+    for (unsigned i = digits; i; --i, value /= 10)
+        p[i - 1] = '0' + value % 10;
+    return p + digits;
+}
+
+char* put_date(char* p, unsigned year, unsigned month, unsigned day)
+{
+    p = put(p, year, 4);
+    *p++ = '-';
+    p = put(p, month, 2);
+    *p++ = '-';
+    return put(p, day, 2);
+}
+
+char* put_time(char* p, unsigned hour, unsigned minute, unsigned second)
+{
+    p = put(p, hour, hour > 99 ? 3 : 2);
+    *p++ = ':';
+    p = put(p, minute, 2);
+    *p++ = ':';
+    return put(p, second, 2);
+}
+
+// Fraction part as my_TIME_to_str() prints it: precision digits, truncated
+char* put_frac(char* p, uint32_t usec, unsigned precision)
+{
+    if (!precision)
+        return p;
+    static const uint32_t div[] = {1000000, 100000, 10000, 1000, 100, 10, 1};
+    *p++ = '.';
+    return put(p, usec / div[precision], precision);
+}
+
+// see localtime_to_TIME() @ sql_time.cc
+std::string format(int64_t usec, unsigned precision, const struct ::tm& tm_)
+{
+    char buf[32];
+    char* p = buf;
+
+    if (usec) {
+        p = put_date(p, (tm_.tm_year + 1900) % 10000, tm_.tm_mon + 1, tm_.tm_mday);
+        *p++ = ' ';
+        p = put_time(p, tm_.tm_hour, tm_.tm_min, std::min(tm_.tm_sec, 59)); // see adjust_leap_second() @ tztime.cc
+        p = put_frac(p, usec % 1000000, precision);
+    } else {
+        p = put_date(p, 0, 0, 0);
+        *p++ = ' ';
+        p = put_time(p, 0, 0, 0);
+        p = put_frac(p, 0, precision);
+    }
+    return std::string(buf, p - buf);
+}
+
+}// anonymous-namespace
+
+namespace slave
+{
+
+// see days_from_civil() @ http://howardhinnant.github.io/date_algorithms.html
+int32_t days_from_civil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = y - era * 400;
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + int(doe) - 719468;
+}
+
+void civil_from_days(int32_t z, int& y, unsigned& m, unsigned& d)
+{
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = z - era * 146097;
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = int(yoe) + era * 400 + (m <= 2);
+}
+
+std::string Timestamp::str() const
+{
+    struct ::tm tm_;
+    if (usec) {
+        const time_t ts = seconds();
+        ::localtime_r(&ts, &tm_);
+    }
+    return format(usec, precision, tm_);
+}
+
+std::string Timestamp::str(const TimeZone& tz) const
+{
+    struct ::tm tm_;
+    if (usec) {
+        TimeZone::Interval cache;
+        tz.localtime(seconds(), tm_, cache);
+    }
+    return format(usec, precision, tm_);
+}
+
+std::string DateTime::str() const
+{
+    char buf[32];
+    char* p = buf;
+
+    p = put_date(p, packed / 10000000000ULL, packed / 100000000 % 100, packed / 1000000 % 100);
+    *p++ = ' ';
+    p = put_time(p, packed / 10000 % 100, packed / 100 % 100, packed % 100);
+    p = put_frac(p, usec, precision);
+    return std::string(buf, p - buf);
+}
+
+Date::Date(unsigned year, unsigned month, unsigned day) :
+    days(month && day ? days_from_civil(year, month, day) : zero + int32_t(year * 10000 + month * 100 + day))
+{}
+
+void Date::parts(int& year, unsigned& month, unsigned& day) const
+{
+    if (isPartial()) {
+        const unsigned packed = days - zero;
+        year = packed / 10000;
+        month = packed / 100 % 100;
+        day = packed % 100;
+    } else {
+        civil_from_days(days, year, month, day);
+    }
+}
+
+std::string Date::str() const
+{
+    char buf[16];
+    int year;
+    unsigned month, day;
+
+    parts(year, month, day);
+    return std::string(buf, put_date(buf, year, month, day) - buf);
+}
+
+std::string Time::str() const
+{
+    char buf[32];
+    char* p = buf;
+
+    uint64_t value = usec;
+    if (usec < 0) {
+        *p++ = '-';
+        value = -uint64_t(usec);
+    }
+    const uint64_t seconds = value / 1000000;
+    p = put_time(p, seconds / 3600, seconds / 60 % 60, seconds % 60);
+    p = put_frac(p, value % 1000000, precision);
+    return std::string(buf, p - buf);
+}
+
+}// slave
@@ -0,0 +1,89 @@
+#ifndef __SLAVE_TEMPORAL_H_
+#define __SLAVE_TEMPORAL_H_
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <string>
+
+namespace slave
+{
+
+class TimeZone;
+
+// Typed temporal values, which fields give instead of strings in typed temporal mode
+// (see Slave::setTypedTemporal()). They are taken from the binlog image by a few integer
+// operations; str() formats the value the same way as the string mode does, when it is needed.
+
+// TIMESTAMP: microseconds since the epoch, UTC. Zero timestamp is 0.
+struct Timestamp
+{
+    int64_t usec = 0;
+    uint8_t precision = 0;
+
+    Timestamp() {}
+    Timestamp(int64_t usec_, uint8_t precision_) : usec(usec_), precision(precision_) {}
+
+    time_t seconds() const { return usec / 1000000; }
+    // In local timezone, '0000-00-00 00:00:00' for zero timestamp
+    std::string str() const;
+    // The same in the given timezone, without localtime_r()
+    std::string str(const TimeZone& tz) const;
+};
+
+// DATETIME: YYYYMMDDhhmmss (i.e. 20110313094909) and microseconds.
+struct DateTime
+{
+    uint64_t packed = 0;
+    uint32_t usec = 0;
+    uint8_t precision = 0;
+
+    DateTime() {}
+    DateTime(uint64_t packed_, uint32_t usec_, uint8_t precision_) : packed(packed_), usec(usec_), precision(precision_) {}
+
+    std::string str() const;
+};
+
+// DATE: days since 1970-01-01. Dates with zero month or day (i.e. '2024-05-00', which servers
+// without NO_ZERO_IN_DATE write) have no day number: they are kept as Date::zero + YYYYMMDD,
+// far below the days of real dates. '0000-00-00' is Date::zero.
+struct Date
+{
+    static const int32_t zero = std::numeric_limits<int32_t>::min();
+
+    int32_t days = zero;
+
+    Date() {}
+    explicit Date(int32_t days_) : days(days_) {}
+    Date(unsigned year, unsigned month, unsigned day);
+
+    bool isZero() const { return days == zero; }
+    // Zero month or day, including '0000-00-00'
+    bool isPartial() const { return days <= zero + max_packed; }
+    // Year, month and day, zero parts included
+    void parts(int& year, unsigned& month, unsigned& day) const;
+    std::string str() const;
+
+private:
+    static const int32_t max_packed = 99991231;
+};
+
+// TIME: signed microseconds, from -838:59:59 to 838:59:59.
+struct Time
+{
+    int64_t usec = 0;
+    uint8_t precision = 0;
+
+    Time() {}
+    Time(int64_t usec_, uint8_t precision_) : usec(usec_), precision(precision_) {}
+
+    std::string str() const;
+};
+
+// Days since 1970-01-01 of the proleptic Gregorian date, and back
+int32_t days_from_civil(int y, unsigned m, unsigned d);
+void civil_from_days(int32_t z, int& y, unsigned& m, unsigned& d);
+
+}// slave
+
+#endif
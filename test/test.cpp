@@ -48,6 +48,21 @@ std::string print(const slave::FieldValue& v) {
         else if (v.type() == typeid(double))
             s << slave::get<double>(v);
 
+        else if (v.type() == typeid(slave::Timestamp))
+            s << "'" << slave::get<slave::Timestamp>(v).str() << "'";
+
+        else if (v.type() == typeid(slave::DateTime))
+            s << "'" << slave::get<slave::DateTime>(v).str() << "'";
+
+        else if (v.type() == typeid(slave::Date))
+            s << "'" << slave::get<slave::Date>(v).str() << "'";
+
+        else if (v.type() == typeid(slave::Time))
+            s << "'" << slave::get<slave::Time>(v).str() << "'";
+
+        else if (v.type() == typeid(slave::Decimal))
+            s << slave::get<slave::Decimal>(v).str();
+
         else if (v.type() == typeid(void))
             s << "void";
 
@@ -91,6 +106,16 @@ void callback(const slave::RecordSet& event) {
             std::cout << "\n";
         }
     }
+    else if (event.row_type == slave::RowType::View)
+    {
+        for (unsigned i = 0; i < event.m_row_view.size(); ++i)
+        {
+            if (!event.m_row_view.has(i))
+                continue;
+            std::cout << "  " << event.m_row_view.getFieldName(i) << " : " << event.m_row_view.getFieldType(i)
+                      << " -> " << print(event.m_row_view.getValue(i)) << "\n";
+        }
+    }
     else
     {
         for (auto it = event.m_row_vec.begin(); it != event.m_row_vec.end(); ++it)
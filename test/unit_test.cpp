@@ -15,9 +15,21 @@ using namespace boost::unit_test;
 #include <functional>
 #include <iostream>
 #include <mutex>
+#include <set>
 #include <thread>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
 #include "Slave.h"
+#include "crc32.h"
 #include "nanomysql.h"
 #include "types.h"
 
@@ -166,6 +178,7 @@ namespace // anonymous
             bool getStateProcessing() override { return false; }
             void initTableCount(const std::string& t) override {}
             void incTableCount(const std::string& t) override {}
+            void addTableCount(const std::string& t, size_t n) override {}
 
         private:
             slave::Position position;
@@ -187,6 +200,7 @@ namespace // anonymous
             uint64_t events_other              = 0;
             uint64_t events_modify             = 0;
             uint64_t rows_modify               = 0;
+            uint64_t rows_batches              = 0;
 
             struct Counter
             {
@@ -262,6 +276,16 @@ namespace // anonymous
                 map_kind[kind].row_done    += time;
                 map_detailed[key].row_done += time;
             }
+
+            void tickModifyRowsDone(const unsigned long id, slave::EventKind kind, size_t rows, uint64_t time) override
+            {
+                rows_modify += rows;
+                ++rows_batches;
+
+                const auto key = std::make_pair(id, kind);
+                map_kind[kind].row_done    += time;
+                map_detailed[key].row_done += time;
+            }
         };
 
         config cfg;
@@ -1631,6 +1655,942 @@ namespace // anonymous
         f.checkInsertValue(uint32_t(12), "12", "", "stat");
     }
 
+    void test_RowView()
+    {
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.setCallback(f.cfg.mysql_db, "test", std::ref(f.m_Callback), slave::RowType::View);
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (id int, value varchar(20), empty int)");
+        f.startSlave();
+
+        int64_t id = 0;
+        std::string value;
+        bool has_empty = false, empty_is_null = false;
+        f.m_Callback.setCallback([&](const slave::RecordSet& rs)
+        {
+            BOOST_CHECK(rs.row_type == slave::RowType::View);
+            BOOST_CHECK(rs.m_row.empty() && rs.m_row_vec.empty());
+            id = rs.m_row_view.getInt64(0);
+            value = rs.m_row_view.getStringRef(1).str();
+            has_empty = rs.m_row_view.has(2);
+            empty_is_null = rs.m_row_view.isNull(2);
+            BOOST_CHECK_EQUAL(rs.m_row_view.getFieldName(1), "value");
+            BOOST_CHECK_THROW(rs.m_row_view.getInt64(2), std::runtime_error);
+        });
+
+        f.conn->query("INSERT INTO test VALUES (42, 'row view', NULL)");
+        f.waitCall();
+        f.m_Callback.setCallback();
+
+        BOOST_CHECK_EQUAL(id, 42);
+        BOOST_CHECK_EQUAL(value, "row view");
+        BOOST_CHECK(has_empty);
+        BOOST_CHECK(empty_is_null);
+    }
+
+    void test_TypedTemporal()
+    {
+        BOOST_CHECK_EQUAL(slave::Date(1970, 1, 1).days, 0);
+        BOOST_CHECK_EQUAL(slave::Date(1969, 12, 31).days, -1);
+        BOOST_CHECK(slave::Date(0, 0, 0).isZero());
+        BOOST_CHECK_EQUAL(slave::Date(0, 0, 0).str(), "0000-00-00");
+        BOOST_CHECK_EQUAL(slave::Date(1600, 3, 1).str(), "1600-03-01");
+        BOOST_CHECK(!slave::Date(1600, 3, 1).isPartial());
+        BOOST_CHECK(!slave::Date(0, 1, 1).isPartial());
+        // Zero month or day (no NO_ZERO_IN_DATE)
+        for (const auto& date : {std::make_tuple(2024, 5u, 0u, "2024-05-00"),
+                                 std::make_tuple(2024, 0u, 0u, "2024-00-00"),
+                                 std::make_tuple(9999, 0u, 31u, "9999-00-31")}) {
+            const slave::Date d(std::get<0>(date), std::get<1>(date), std::get<2>(date));
+            BOOST_CHECK(d.isPartial());
+            BOOST_CHECK(!d.isZero());
+            BOOST_CHECK_EQUAL(d.str(), std::get<3>(date));
+            int year;
+            unsigned month, day;
+            slave::get<slave::Date>(slave::FieldValue(d)).parts(year, month, day);
+            BOOST_CHECK_EQUAL(year, std::get<0>(date));
+            BOOST_CHECK_EQUAL(month, std::get<1>(date));
+            BOOST_CHECK_EQUAL(day, std::get<2>(date));
+        }
+        BOOST_CHECK_EQUAL(slave::Timestamp(0, 2).str(), "0000-00-00 00:00:00.00");
+        BOOST_CHECK_EQUAL(slave::Time(-1500000, 1).str(), "-00:00:01.5");
+
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.setTypedTemporal();
+        f.m_Slave.setCallback(f.cfg.mysql_db, "test", std::ref(f.m_Callback));
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (ts timestamp(3) NULL, dt datetime(6), d date, t time)");
+        f.startSlave();
+
+        slave::Timestamp ts;
+        slave::DateTime dt;
+        slave::Date d;
+        slave::Time t;
+        f.m_Callback.setCallback([&](const slave::RecordSet& rs)
+        {
+            ts = slave::get<slave::Timestamp>(rs.m_row.at("ts").second);
+            dt = slave::get<slave::DateTime>(rs.m_row.at("dt").second);
+            d = slave::get<slave::Date>(rs.m_row.at("d").second);
+            t = slave::get<slave::Time>(rs.m_row.at("t").second);
+        });
+
+        f.conn->query("SET time_zone = '+00:00'");
+        f.conn->query("INSERT INTO test VALUES ('2020-02-29 12:34:56.789', '1999-12-31 23:59:59.123456', '2020-02-29', '-838:59:59')");
+        f.waitCall();
+        f.m_Callback.setCallback();
+
+        BOOST_CHECK_EQUAL(ts.usec, 1582979696789000LL);
+        BOOST_CHECK_EQUAL(ts.precision, 3);
+        BOOST_CHECK_EQUAL(dt.packed, 19991231235959ULL);
+        BOOST_CHECK_EQUAL(dt.usec, 123456);
+        BOOST_CHECK_EQUAL(dt.str(), "1999-12-31 23:59:59.123456");
+        BOOST_CHECK_EQUAL(d.days, 18321);
+        BOOST_CHECK_EQUAL(d.str(), "2020-02-29");
+        BOOST_CHECK_EQUAL(t.usec, -3020399000000LL);
+        BOOST_CHECK_EQUAL(t.str(), "-838:59:59");
+    }
+
+    void test_TimeZone()
+    {
+        const auto tz = slave::TimeZone::load("CET-1CEST,M3.5.0,M10.5.0/3");
+        slave::TimeZone::Interval cache;
+        struct tm tm;
+
+        auto check = [&](int64_t t, int hour, int minute, int second, bool dst)
+        {
+            tz->localtime(t, tm, cache);
+            BOOST_CHECK_EQUAL(tm.tm_hour, hour);
+            BOOST_CHECK_EQUAL(tm.tm_min, minute);
+            BOOST_CHECK_EQUAL(tm.tm_sec, second);
+            BOOST_CHECK_EQUAL(tm.tm_isdst, dst);
+        };
+        // 2020-01-01 00:00:00 UTC
+        check(1577836800, 1, 0, 0, false);
+        // DST starts at 2020-03-29 01:00:00 UTC
+        check(1585443599, 1, 59, 59, false);
+        BOOST_CHECK(cache.contains(1585443599) && !cache.contains(1585443600));
+        check(1585443600, 3, 0, 0, true);
+        BOOST_CHECK_EQUAL(tm.tm_mon, 2);
+        BOOST_CHECK_EQUAL(tm.tm_mday, 29);
+
+        BOOST_CHECK_EQUAL(slave::Timestamp(1593604800123456LL, 3).str(*tz), "2020-07-01 14:00:00.123");
+        BOOST_CHECK_EQUAL(slave::Timestamp(0, 0).str(*slave::TimeZone::load("UTC0")), "0000-00-00 00:00:00");
+        BOOST_CHECK_THROW(slave::TimeZone::load("no/such/zone"), std::runtime_error);
+    }
+
+    void test_TypedDecimal()
+    {
+        // 1234567890.1234 as DECIMAL(14,4), see dec_util.h
+        const char positive[] = "\x81\x0D\xFB\x38\xD2\x04\xD2";
+        // -1234567890.1234: bytes are inverted
+        const char negative[] = "\x7E\xF2\x04\xC7\x2D\xFB\x2D";
+
+        slave::Field_decimal field("price", "decimal(14,4)", 16, 4, false, true);
+        BOOST_CHECK_EQUAL(field.pack_length(positive), 7);
+        BOOST_CHECK_EQUAL(field.unpack(positive), positive + 7);
+
+        slave::Decimal value = slave::get<slave::Decimal>(field.field_data);
+        BOOST_CHECK_EQUAL(value.unscaled(), 12345678901234LL);
+        BOOST_CHECK_EQUAL(value.precision, 14);
+        BOOST_CHECK_EQUAL(value.scale, 4);
+        BOOST_CHECK_EQUAL(value.str(), "1234567890.1234");
+        BOOST_CHECK_EQUAL(value.toDouble(), 1234567890.1234);
+        BOOST_CHECK_EQUAL(field.get_double(positive), 1234567890.1234);
+
+        field.unpack(negative);
+        value = slave::get<slave::Decimal>(field.field_data);
+        BOOST_CHECK_EQUAL(value.unscaled(), -12345678901234LL);
+        BOOST_CHECK_EQUAL(value.str(), "-1234567890.1234");
+
+        BOOST_CHECK_EQUAL(slave::Decimal(5, 4, 4).str(), "0.0005");
+        BOOST_CHECK_EQUAL(slave::Decimal(-5, 4, 2).str(), "-0.05");
+        BOOST_CHECK_EQUAL(slave::Decimal(0, 4, 2).str(), "0.00");
+
+        // Too wide for Decimal, is given as string
+        slave::Field_decimal wide("wide", "decimal(65,30)", 67, 30, false, true);
+        std::string zero(wide.pack_length(nullptr), '\0');
+        zero[0] = '\x80';
+        wide.unpack(zero.data());
+        BOOST_CHECK(field.field_data.type() == typeid(slave::Decimal));
+        BOOST_CHECK(wide.field_data.type() == typeid(std::string));
+    }
+
+    void test_DecodePlan()
+    {
+        slave::Table table("db", "plan");
+        table.fields.emplace_back(new slave::Field_num<int16, 1>("tiny", "tinyint(4)"));
+        table.fields.emplace_back(new slave::Field_num<uint32, 3>("medium", "mediumint(8) unsigned"));
+        table.fields.emplace_back(new slave::Field_num<double>("real", "double"));
+        table.fields.emplace_back(new slave::Field_date("day", "date"));
+        table.fields.emplace_back(new slave::Field_string("name", "varchar(20)", 20));
+        table.compile_decode_plan();
+
+        BOOST_REQUIRE_EQUAL(table.decode_plan.size(), 5);
+        BOOST_CHECK(table.decode_plan[0].kind == slave::DecodeOp::Int8);
+        BOOST_CHECK(table.decode_plan[1].kind == slave::DecodeOp::UInt24);
+        BOOST_CHECK_EQUAL(table.decode_plan[1].length, 3);
+        BOOST_CHECK(table.decode_plan[2].kind == slave::DecodeOp::Double);
+        BOOST_CHECK(table.decode_plan[3].kind == slave::DecodeOp::Generic);
+        BOOST_CHECK_EQUAL(table.decode_plan[3].length, 3);
+        BOOST_CHECK(table.decode_plan[4].kind == slave::DecodeOp::String);
+        BOOST_CHECK_EQUAL(table.decode_plan[4].length, 0);
+        BOOST_CHECK(table.decode_plan[4].field == table.fields[4].get());
+    }
+
+    void test_FieldValue()
+    {
+        BOOST_CHECK_EQUAL(sizeof(slave::FieldValue), 16);
+
+        slave::FieldValue v;
+        BOOST_CHECK(slave::isNullFieldValue(v));
+        BOOST_CHECK(v.type() == typeid(void));
+
+        v = uint32_t(4000000000u);
+        BOOST_CHECK(v.type() == typeid(uint32_t));
+        BOOST_CHECK_EQUAL(slave::get<uint32_t>(v), 4000000000u);
+        BOOST_CHECK_THROW(slave::get<int32_t>(v), std::bad_cast);
+        BOOST_CHECK_THROW(slave::get<std::string>(v), std::bad_cast);
+
+        const std::string small = "fits inline";
+        const std::string large(1000, 'x');
+        v = small;
+        slave::FieldValue w = large;
+        BOOST_CHECK_EQUAL(slave::get<std::string>(v), small);
+        BOOST_CHECK_EQUAL(slave::get<std::string>(w), large);
+        BOOST_CHECK_EQUAL(slave::get<std::string>(slave::FieldValue(std::string())), "");
+
+        slave::FieldValue copy = w;
+        const slave::FieldValue moved = std::move(w);
+        BOOST_CHECK(slave::isNullFieldValue(w));
+        BOOST_CHECK_EQUAL(slave::get<std::string>(copy), large);
+        BOOST_CHECK_EQUAL(slave::get<std::string>(moved), large);
+        BOOST_CHECK(slave::get<slave::StringRef>(copy).data != slave::get<slave::StringRef>(moved).data);
+
+        v = slave::DateTime(20110313094909ULL, 123456, 6);
+        BOOST_CHECK_EQUAL(slave::get<slave::DateTime>(v).str(), "2011-03-13 09:49:09.123456");
+        v = slave::Decimal(-123456, 18, 2);
+        BOOST_CHECK_EQUAL(slave::get<slave::Decimal>(v).str(), "-1234.56");
+        v = slave::Decimal(__int128(1) << 100, 38, 0);
+        copy = v;
+        BOOST_CHECK(slave::get<slave::Decimal>(copy).value == __int128(1) << 100);
+    }
+
+    void test_ZeroCopyStrings()
+    {
+        std::string buffer(100, 'a');
+        const slave::StringRef ref(buffer.data(), buffer.size());
+
+        slave::FieldValue v = slave::FieldValue::reference(ref);
+        BOOST_CHECK(v.isReference());
+        BOOST_CHECK(slave::get<slave::StringRef>(v).data == buffer.data());
+        BOOST_CHECK(v.type() == typeid(std::string));
+
+        // Short strings are copied inline anyway
+        BOOST_CHECK(!slave::FieldValue::reference(slave::StringRef(buffer.data(), 10)).isReference());
+
+        slave::RecordSet rs;
+        rs.m_row_vec.emplace_back(slave::SchemaString("blob"), v);
+        rs.materialize();
+        v.materialize();
+        buffer.assign(100, 'b');
+        BOOST_CHECK(!v.isReference());
+        BOOST_CHECK_EQUAL(slave::get<std::string>(v), std::string(100, 'a'));
+        BOOST_CHECK_EQUAL(slave::get<std::string>(rs.m_row_vec[0].second), std::string(100, 'a'));
+    }
+
+    void test_Schema()
+    {
+        slave::Table table("db", "schema");
+        table.fields.emplace_back(new slave::Field_num<uint32>("id", "int(10) unsigned"));
+        table.fields.emplace_back(new slave::Field_string("name", "varchar(255)", 255));
+        table.compile_decode_plan();
+
+        slave::PtrSchema schema = table.schema;
+        BOOST_REQUIRE(schema);
+        BOOST_CHECK_EQUAL(schema->index("name"), 1);
+        BOOST_CHECK_EQUAL(schema->index("none"), -1);
+
+        slave::Row row;
+        row[schema->names[0]] = std::make_pair(schema->types[0], slave::FieldValue(uint32_t(1)));
+        BOOST_CHECK(row.at("id").first == "int(10) unsigned");
+        BOOST_CHECK(row.at("id").first.data() == slave::SchemaString::intern("int(10) unsigned").data());
+        BOOST_CHECK(row.find(std::string("id")) != row.end());
+        BOOST_CHECK(row.find("name") == row.end());
+        BOOST_CHECK_EQUAL(std::string(row.begin()->first.c_str()), "id");
+
+        // Rows do not depend on the schema, which is dropped when the table is rebuilt
+        const slave::Row copy = row;
+        schema.reset();
+        table.compile_decode_plan();
+        BOOST_CHECK(table.schema->names[0].data() == copy.begin()->first.data());
+        BOOST_CHECK_EQUAL(copy.begin()->first, "id");
+        BOOST_CHECK_EQUAL(copy.at("id").first, "int(10) unsigned");
+    }
+
+    void test_ReuseRecordSets()
+    {
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.setReuseRecordSets();
+        f.m_Slave.setCallback(f.cfg.mysql_db, "test", std::ref(f.m_Callback), slave::RowType::Vector);
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (id int, value varchar(20))");
+        f.startSlave();
+
+        std::vector<const slave::RecordSet*> record_sets;
+        std::vector<std::pair<uint32_t, std::string>> rows;
+        f.m_Callback.setCallback([&](slave::RecordSet& rs)
+        {
+            record_sets.push_back(&rs);
+            BOOST_REQUIRE_EQUAL(rs.m_row_vec.size(), 2);
+            BOOST_CHECK(rs.m_old_row_vec.empty());
+            const slave::FieldValue& value = rs.m_row_vec[1].second;
+            rows.emplace_back(slave::get<uint32_t>(rs.m_row_vec[0].second),
+                              slave::isNullFieldValue(value) ? "NULL" : slave::get<std::string>(value));
+        });
+
+        f.conn->query("INSERT INTO test VALUES (1, 'one'), (2, NULL)");
+        f.conn->query("INSERT INTO test VALUES (3, 'three')");
+        f.waitCall();
+        f.m_Callback.setCallback();
+
+        BOOST_REQUIRE_EQUAL(rows.size(), 3);
+        BOOST_CHECK(rows[0] == std::make_pair(1u, std::string("one")));
+        BOOST_CHECK(rows[1] == std::make_pair(2u, std::string("NULL")));
+        BOOST_CHECK(rows[2] == std::make_pair(3u, std::string("three")));
+        BOOST_CHECK(record_sets[0] == record_sets[1] && record_sets[1] == record_sets[2]);
+    }
+
+    void test_PresentColumns()
+    {
+        // UPDATE_ROWS v2 header of a 12-column table: before image has columns 0, 2, 5, 7, 9,
+        // after image - column 11 only
+        std::string event(LOG_EVENT_HEADER_LEN + ROWS_HEADER_LEN, '\0');
+        event[LOG_EVENT_HEADER_LEN + ROWS_HEADER_LEN - 2] = 2;
+        event += std::string("\x0C" "\xA5\x02" "\x00\x08", 5);
+
+        const slave::Row_event_info roi(event.data(), event.size(), true, true);
+        BOOST_CHECK_EQUAL(roi.m_width, 12);
+        BOOST_CHECK(roi.m_present == std::vector<unsigned>({0, 2, 5, 7, 9}));
+        BOOST_CHECK(roi.m_present_ai == std::vector<unsigned>({11}));
+        BOOST_CHECK(roi.m_rows_buf == (const unsigned char*)event.data() + event.size());
+    }
+
+    void test_TableIdCache()
+    {
+        slave::RelayLogInfo rli;
+        rli.setTable("a", "db", slave::PtrTable(new slave::Table("db", "a")));
+        rli.setTableName(1, "a", "db");
+        rli.setTableName(1 + 256, "b", "db");
+
+        const slave::Table* a = rli.getTableById(1);
+        BOOST_REQUIRE(a);
+        BOOST_CHECK_EQUAL(a->full_name, "db.a");
+        // Not built yet, then built: the cache must not keep the miss
+        BOOST_CHECK(!rli.getTableById(1 + 256));
+        rli.setTable("b", "db", slave::PtrTable(new slave::Table("db", "b")));
+        BOOST_REQUIRE(rli.getTableById(1 + 256));
+        BOOST_CHECK_EQUAL(rli.getTableById(1 + 256)->full_name, "db.b");
+        BOOST_CHECK(rli.getTableById(1) == a);
+        BOOST_CHECK(!rli.getTableById(2));
+
+        // Rebuild replaces the table
+        rli.setTable("a", "db", slave::PtrTable(new slave::Table("db", "a")));
+        BOOST_CHECK(rli.getTableById(1) == rli.getTable(std::make_pair("db", "a")).get());
+    }
+
+    void test_SkipRowEvent()
+    {
+        // TABLE_MAP event up to the names
+        std::string table_map(LOG_EVENT_HEADER_LEN + TABLE_MAP_HEADER_LEN, '\0');
+        table_map += std::string("\x02" "db\0" "\x05" "table\0", 10);
+        std::pair<std::string, std::string> names;
+        slave::table_map_names(table_map.data(), table_map.size(), names);
+        BOOST_CHECK_EQUAL(names.first, "db");
+        BOOST_CHECK_EQUAL(names.second, "table");
+        BOOST_CHECK_THROW(slave::table_map_names(table_map.data(), table_map.size() - 3, names), std::runtime_error);
+
+        struct Stat : slave::EventStatIface
+        {
+            unsigned ignored = 0, filtered = 0;
+            void tickModifyEventIgnored(const unsigned long, slave::EventKind) override { ++ignored; }
+            void tickModifyEventFiltered(const unsigned long, slave::EventKind) override { ++filtered; }
+        } stat;
+
+        slave::RelayLogInfo rli;
+        slave::PtrTable table(new slave::Table("db", "table"));
+        table->m_filter = slave::eInsert;
+        rli.setTable("table", "db", std::move(table));
+        rli.setTableName(7, "table", "db");
+
+        std::string event(LOG_EVENT_HEADER_LEN + ROWS_HEADER_LEN, '\0');
+        slave::Basic_event_info bei;
+        bei.buf = event.data();
+        bei.event_len = event.size();
+
+        // Unknown table
+        bei.type = slave::WRITE_ROWS_EVENT;
+        event[LOG_EVENT_HEADER_LEN + ROWS_MAPID_OFFSET] = 8;
+        BOOST_CHECK(slave::skip_row_event(rli, bei, &stat));
+        BOOST_CHECK_EQUAL(stat.ignored, 1);
+        BOOST_CHECK_EQUAL(stat.filtered, 0);
+
+        // Known table, kind out of the filter
+        event[LOG_EVENT_HEADER_LEN + ROWS_MAPID_OFFSET] = 7;
+        bei.type = slave::DELETE_ROWS_EVENT;
+        BOOST_CHECK(slave::skip_row_event(rli, bei, &stat));
+        BOOST_CHECK_EQUAL(stat.ignored, 2);
+        BOOST_CHECK_EQUAL(stat.filtered, 1);
+
+        bei.type = slave::WRITE_ROWS_EVENT;
+        BOOST_CHECK(!slave::skip_row_event(rli, bei, &stat));
+        BOOST_CHECK_EQUAL(stat.ignored, 2);
+    }
+
+    void test_RawEventFilter()
+    {
+        // Raw event of the type with the body after the common header
+        const auto event = [](slave::Log_event_type type, const std::string& body)
+        {
+            std::string e(LOG_EVENT_HEADER_LEN, '\0');
+            e[EVENT_TYPE_OFFSET] = type;
+            return e + body;
+        };
+        const auto table_map = [&event](unsigned char id, const std::string& db, const std::string& table)
+        {
+            std::string body(TABLE_MAP_HEADER_LEN, '\0');
+            body[TM_MAPID_OFFSET] = id;
+            body += char(db.size()) + db + '\0' + char(table.size()) + table + '\0';
+            return event(slave::TABLE_MAP_EVENT, body);
+        };
+        const auto rows = [&event](unsigned char id)
+        {
+            std::string body(ROWS_HEADER_LEN + 8, '\0');
+            body[ROWS_MAPID_OFFSET] = id;
+            return event(slave::WRITE_ROWS_EVENT, body);
+        };
+        const auto query = [&event](const std::string& q)
+        {
+            return event(slave::QUERY_EVENT, std::string(QUERY_HEADER_LEN, '\0') + '\0' + q);
+        };
+
+        struct Stat : slave::EventStatIface
+        {
+            unsigned events = 0;
+            unsigned long bytes = 0;
+            void tickEventSkipped(unsigned long b) override { ++events; bytes += b; }
+        } stat;
+
+        const slave::RawEventFilter::tables_t tables = {{"db", "a"}};
+        slave::RawEventFilter filter(tables);
+        std::vector<std::string> passed;
+        const auto feed = [&](const std::string& e)
+        {
+            filter.feed(e.data(), e.size(), &stat, [&passed](const char* buf, unsigned long len) { passed.emplace_back(buf, len); });
+        };
+
+        // Transaction of the other table is dropped, except of GTID and XID
+        const std::string begin = query("BEGIN");
+        feed(event(slave::GTID_LOG_EVENT, std::string(25, '\0')));
+        feed(begin);
+        feed(table_map(1, "db", "b"));
+        feed(rows(1));
+        feed(event(slave::XID_EVENT, std::string(8, '\0')));
+        BOOST_REQUIRE_EQUAL(passed.size(), 2);
+        BOOST_CHECK_EQUAL(passed[0][EVENT_TYPE_OFFSET], slave::GTID_LOG_EVENT);
+        BOOST_CHECK_EQUAL(passed[1][EVENT_TYPE_OFFSET], slave::XID_EVENT);
+        BOOST_CHECK_EQUAL(stat.events, 3);
+        BOOST_CHECK_EQUAL(stat.bytes, begin.size() + table_map(1, "db", "b").size() + rows(1).size());
+
+        // BEGIN (with checksum) goes before the first event let through, rows of the other table are dropped
+        passed.clear();
+        feed(begin + "CRC!");
+        BOOST_CHECK(passed.empty());
+        feed(table_map(2, "db", "a"));
+        feed(table_map(3, "db", "b"));
+        feed(rows(3));
+        feed(rows(2));
+        feed(query("COMMIT"));
+        BOOST_REQUIRE_EQUAL(passed.size(), 4);
+        BOOST_CHECK(passed[0] == begin + "CRC!");
+        BOOST_CHECK(passed[1] == table_map(2, "db", "a"));
+        BOOST_CHECK(passed[2] == rows(2));
+        BOOST_CHECK(passed[3] == query("COMMIT"));
+        BOOST_CHECK_EQUAL(stat.events, 5);
+
+        // Table ids are forgotten after the transaction
+        passed.clear();
+        feed(begin);
+        feed(rows(2));
+        filter.reset();
+        feed(query("CREATE TABLE b (id int)"));
+        BOOST_REQUIRE_EQUAL(passed.size(), 1);
+        BOOST_CHECK_EQUAL(stat.events, 6);
+    }
+
+    void test_TransactionPayload()
+    {
+        // Events with the length in the header; the second one is larger than a chunk of zstd
+        std::vector<std::string> events;
+        for (size_t size : {40, 300000, 27}) {
+            std::string e(size, char('a' + events.size()));
+            e[EVENT_TYPE_OFFSET] = slave::QUERY_EVENT;
+            for (int i = 0; i < 4; ++i)
+                e[EVENT_LEN_OFFSET + i] = char(size >> (8 * i));
+            events.push_back(e);
+        }
+        std::string payload;
+        for (const auto& e : events)
+            payload += e;
+
+        // Field of the payload header: type, length and packed value
+        const auto field = [](char type, uint64_t value)
+        {
+            if (value < 251)
+                return std::string(1, type) + '\x01' + char(value);
+            if (value < (1 << 24))
+                return std::string(1, type) + '\x04' + '\xfd' + char(value) + char(value >> 8) + char(value >> 16);
+            std::string f = std::string(1, type) + '\x09' + '\xfe';
+            for (int i = 0; i < 8; ++i)
+                f += char(value >> (8 * i));
+            return f;
+        };
+        const auto payload_event = [&field](unsigned compression, const std::string& data, uint64_t uncompressed)
+        {
+            std::string e(LOG_EVENT_HEADER_LEN, '\0');
+            e[EVENT_TYPE_OFFSET] = slave::TRANSACTION_PAYLOAD_EVENT;
+            // Compression type, uncompressed size, payload size, end mark
+            e += field(2, compression) + field(3, uncompressed) + field(1, data.size()) + '\0';
+            return e + data;
+        };
+
+        slave::PayloadReader reader;
+        std::vector<std::string> unpacked;
+        const auto collect = [&unpacked](char* buf, unsigned long len) { unpacked.emplace_back(buf, len); };
+
+        std::string event = payload_event(slave::Transaction_payload_event_info::None, payload, payload.size());
+        const slave::Transaction_payload_event_info plain(event.data(), event.size());
+        BOOST_CHECK_EQUAL(plain.m_compression, slave::Transaction_payload_event_info::None);
+        BOOST_CHECK_EQUAL(plain.m_uncompressed_size, payload.size());
+        BOOST_CHECK_EQUAL(plain.m_payload_size, payload.size());
+        reader.unpack(plain, collect);
+        BOOST_CHECK(unpacked == events);
+
+        // Payload out of the event
+        BOOST_CHECK_THROW(slave::Transaction_payload_event_info(event.data(), event.size() - 1), std::runtime_error);
+
+        // Declared size differs
+        event = payload_event(slave::Transaction_payload_event_info::None, payload, payload.size() + 1);
+        BOOST_CHECK_THROW(reader.unpack(slave::Transaction_payload_event_info(event.data(), event.size()), collect), std::runtime_error);
+
+#ifdef WITH_ZSTD
+        std::string compressed(ZSTD_compressBound(payload.size()), '\0');
+        compressed.resize(ZSTD_compress(&compressed[0], compressed.size(), payload.data(), payload.size(), 3));
+        event = payload_event(slave::Transaction_payload_event_info::Zstd, compressed, payload.size());
+        const slave::Transaction_payload_event_info tpi(event.data(), event.size());
+
+        // Streaming and kept
+        for (int keep = 0; keep < 2; ++keep) {
+            unpacked.clear();
+            std::vector<char> buffer;
+            reader.unpack(tpi, collect, keep ? &buffer : nullptr);
+            BOOST_CHECK(unpacked == events);
+        }
+
+        // Truncated payload
+        event = payload_event(slave::Transaction_payload_event_info::Zstd, compressed.substr(0, compressed.size() / 2), payload.size());
+        BOOST_CHECK_THROW(reader.unpack(slave::Transaction_payload_event_info(event.data(), event.size()), collect), std::runtime_error);
+
+        // Declared size differs from the decompressed one, or is huge: nothing is given out,
+        // and the buffer does not follow the declared size
+        for (uint64_t declared : {uint64_t(payload.size() - 1), uint64_t(payload.size() + 1), uint64_t(1) << 40}) {
+            event = payload_event(slave::Transaction_payload_event_info::Zstd, compressed, declared);
+            const slave::Transaction_payload_event_info bad(event.data(), event.size());
+            for (int keep = 0; keep < 2; ++keep) {
+                unpacked.clear();
+                std::vector<char> buffer;
+                BOOST_CHECK_THROW(reader.unpack(bad, collect, keep ? &buffer : nullptr), std::runtime_error);
+                BOOST_CHECK(buffer.capacity() < (size_t(1) << 30));
+                if (keep)
+                    BOOST_CHECK(unpacked.empty());
+            }
+        }
+#endif
+    }
+
+    void test_SocketReceivedBytes()
+    {
+        BOOST_CHECK_EQUAL(slave::socket_received_bytes(-1), 0);
+
+        // Loopback connection
+        const int server = ::socket(AF_INET, SOCK_STREAM, 0);
+        BOOST_REQUIRE(server >= 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        BOOST_REQUIRE_EQUAL(::bind(server, (sockaddr*)&addr, addr_len), 0);
+        BOOST_REQUIRE_EQUAL(::listen(server, 1), 0);
+        BOOST_REQUIRE_EQUAL(::getsockname(server, (sockaddr*)&addr, &addr_len), 0);
+        const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+        BOOST_REQUIRE_EQUAL(::connect(client, (sockaddr*)&addr, addr_len), 0);
+        const int accepted = ::accept(server, nullptr, nullptr);
+        BOOST_REQUIRE(accepted >= 0);
+
+        const uint64_t before = slave::socket_received_bytes(client);
+        const std::string data(10000, 'x');
+        BOOST_REQUIRE_EQUAL(::write(accepted, data.data(), data.size()), data.size());
+        std::string got(data.size(), '\0');
+        size_t read = 0;
+        while (read < got.size()) {
+            const ssize_t n = ::read(client, &got[read], got.size() - read);
+            BOOST_REQUIRE(n > 0);
+            read += n;
+        }
+#ifdef __linux__
+        BOOST_CHECK_EQUAL(slave::socket_received_bytes(client) - before, data.size());
+#else
+        BOOST_CHECK_EQUAL(slave::socket_received_bytes(client), 0);
+#endif
+        // Not a TCP socket
+        int fds[2];
+        BOOST_REQUIRE_EQUAL(::pipe(fds), 0);
+        BOOST_CHECK_EQUAL(slave::socket_received_bytes(fds[0]), 0);
+        ::close(fds[0]);
+        ::close(fds[1]);
+
+        ::close(accepted);
+        ::close(client);
+        ::close(server);
+    }
+
+    void test_CompressionOptions()
+    {
+        nanomysql::mysql_conn_opts opts;
+        auto compression = nanomysql::Connection::checkOptions(opts);
+        BOOST_CHECK(!compression.zlib && !compression.zstd && !compression.uncompressed);
+
+        opts.mysql_compression = "zstd,zlib,uncompressed";
+        compression = nanomysql::Connection::checkOptions(opts);
+        BOOST_CHECK(compression.zlib && compression.zstd && compression.uncompressed);
+
+        for (const char* invalid : {"zsdt", "zlib,", ",zlib", "zlib, zstd", "ZLIB"}) {
+            opts.mysql_compression = invalid;
+            BOOST_CHECK_THROW(nanomysql::Connection::checkOptions(opts), std::runtime_error);
+        }
+
+        opts.mysql_compression = "zlib";
+        for (unsigned level : {0, 23}) {
+            opts.mysql_zstd_level = level;
+            BOOST_CHECK_THROW(nanomysql::Connection::checkOptions(opts), std::runtime_error);
+        }
+        opts.mysql_zstd_level = 22;
+        BOOST_CHECK(nanomysql::Connection::checkOptions(opts).zlib);
+    }
+
+    void test_Crc32()
+    {
+        std::vector<unsigned char> data(300 + 16);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = i * 2654435761U >> 24;
+
+        // Lengths around the 64- and 16-byte folding blocks and their tails, unaligned starts,
+        // zero and non-zero initial crc
+        const auto& impls = slave::crc32_impls();
+        BOOST_REQUIRE(!impls.empty());
+        for (const auto& impl : impls)
+            for (size_t offset = 0; offset < 16; ++offset)
+                for (size_t len = 0; len <= 300; ++len)
+                    for (uint32_t crc : {0U, 0x12345678U}) {
+                        const uint32_t expected = ::crc32(crc, data.data() + offset, len);
+                        const uint32_t got = impl.func(crc, data.data() + offset, len);
+                        if (got != expected)
+                            BOOST_ERROR(impl.name << ": offset " << offset << ", length " << len
+                                        << ", crc " << crc << ": " << got << " != " << expected);
+                    }
+
+        const std::string check = "123456789";
+        BOOST_CHECK_EQUAL(slave::checksum_crc32(0, (const unsigned char*)check.data(), check.size()), 0xcbf43926U);
+    }
+
+    void test_BatchCallback()
+    {
+        Fixture f;
+        f.stopSlave();
+        std::vector<std::vector<uint32_t>> batches;
+        f.m_Slave.setBatchCallback(f.cfg.mysql_db, "test", [&batches](slave::RecordSetBatch& batch)
+        {
+            batches.emplace_back();
+            for (const auto& rs : batch)
+            {
+                BOOST_CHECK_EQUAL(rs.type_event, slave::RecordSet::Write);
+                batches.back().push_back(slave::get<uint32_t>(rs.m_row.at("value").second));
+            }
+        });
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (value int)");
+        f.startSlave();
+
+        f.conn->query("INSERT INTO test VALUES (1), (2), (3)");
+        f.conn->query("INSERT INTO test VALUES (4)");
+        f.waitCall();
+
+        BOOST_REQUIRE_EQUAL(batches.size(), 2);
+        BOOST_CHECK(batches[0] == std::vector<uint32_t>({1, 2, 3}));
+        BOOST_CHECK(batches[1] == std::vector<uint32_t>({4}));
+        // One stats call per batch
+        BOOST_CHECK_EQUAL(f.m_SlaveStat.rows_modify, 4);
+        BOOST_CHECK_EQUAL(f.m_SlaveStat.rows_batches, 2);
+    }
+
+    void test_TransactionCallback()
+    {
+        Fixture f;
+        f.stopSlave();
+        std::vector<slave::Transaction> trxs;
+        f.m_Slave.setTransactionCallback([&trxs](slave::Transaction& trx)
+        {
+            trxs.push_back(trx);
+        });
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (value int) ENGINE=InnoDB");
+        f.conn->query("DROP TABLE IF EXISTS stat");
+        f.conn->query("CREATE TABLE stat (value int) ENGINE=InnoDB");
+        f.startSlave();
+
+        f.conn->query("BEGIN");
+        f.conn->query("INSERT INTO test VALUES (1)");
+        f.conn->query("INSERT INTO stat VALUES (2)");
+        f.conn->query("UPDATE test SET value = 3");
+        f.conn->query("COMMIT");
+        f.conn->query("INSERT INTO test VALUES (4)");
+        f.waitCall();
+
+        if (0 != f.m_Callback.m_UnwantedCalls)
+            BOOST_ERROR("Table callbacks are called in transaction mode: " << f.m_Callback.m_UnwantedCalls);
+
+        BOOST_REQUIRE_EQUAL(trxs.size(), 2);
+        BOOST_REQUIRE_EQUAL(trxs[0].rows.size(), 3);
+        BOOST_CHECK_EQUAL(trxs[0].rows[0].tbl_name, "test");
+        BOOST_CHECK_EQUAL(trxs[0].rows[1].tbl_name, "stat");
+        BOOST_CHECK_EQUAL(trxs[0].rows[2].type_event, slave::RecordSet::Update);
+        BOOST_CHECK_EQUAL(slave::get<uint32_t>(trxs[0].rows[2].m_row.at("value").second), 3);
+        BOOST_CHECK_EQUAL(trxs[1].rows.size(), 1);
+        BOOST_CHECK(trxs[0].position.log_pos < trxs[1].position.log_pos);
+
+        slave::Position pos;
+        f.m_ExtState.getMasterPosition(pos);
+        BOOST_CHECK_EQUAL(pos.log_pos, trxs[1].position.log_pos);
+    }
+
+    void test_Pipeline()
+    {
+        Fixture f;
+        f.stopSlave();
+        // Small ring, to make it wrap around a few times
+        f.m_Slave.enablePipeline(4);
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (value int)");
+        f.startSlave();
+
+        std::vector<uint32_t> values;
+        std::thread::id thread_id;
+        f.m_Callback.setCallback([&](slave::RecordSet& rs)
+        {
+            values.push_back(slave::get<uint32_t>(rs.m_row.at("value").second));
+            thread_id = std::this_thread::get_id();
+        });
+
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < 20; ++i)
+        {
+            f.conn->query("INSERT INTO test VALUES (" + std::to_string(i) + ")");
+            expected.push_back(i);
+        }
+        f.waitCall();
+        f.m_Callback.setCallback();
+
+        BOOST_CHECK(values == expected);
+        BOOST_CHECK(thread_id != f.m_SlaveThread.get_id());
+    }
+
+    void test_Workers()
+    {
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.enableWorkers(2, 4);
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (value int)");
+        f.conn->query("DROP TABLE IF EXISTS stat");
+        f.conn->query("CREATE TABLE stat (value int)");
+        f.startSlave();
+
+        // Fixture callback is called under mutex
+        std::map<std::string, std::vector<uint32_t>> values;
+        std::set<std::thread::id> threads;
+        f.m_Callback.setCallback([&](slave::RecordSet& rs)
+        {
+            values[rs.tbl_name].push_back(slave::get<uint32_t>(rs.m_row.at("value").second));
+            threads.insert(std::this_thread::get_id());
+        });
+
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < 20; ++i)
+        {
+            f.conn->query("INSERT INTO test VALUES (" + std::to_string(i) + ")");
+            f.conn->query("INSERT INTO stat VALUES (" + std::to_string(i) + ")");
+            expected.push_back(i);
+        }
+        // Position is advanced only after workers are done
+        f.waitCall();
+        f.m_Callback.setCallback();
+
+        BOOST_CHECK(values["test"] == expected);
+        BOOST_CHECK(values["stat"] == expected);
+        BOOST_CHECK_EQUAL(threads.size(), 2);
+        BOOST_CHECK(threads.count(f.m_SlaveThread.get_id()) == 0);
+    }
+
+    void test_KeyColumns()
+    {
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.enableWorkers(4, 4);
+        f.m_Slave.setKeyColumns(f.cfg.mysql_db, "test", {0});
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (id int, value int)");
+        f.startSlave();
+
+        std::map<uint32_t, std::vector<uint32_t>> values;
+        std::set<std::thread::id> threads;
+        f.m_Callback.setCallback([&](slave::RecordSet& rs)
+        {
+            values[slave::get<uint32_t>(rs.m_row.at("id").second)].push_back(slave::get<uint32_t>(rs.m_row.at("value").second));
+            threads.insert(std::this_thread::get_id());
+        });
+
+        std::map<uint32_t, std::vector<uint32_t>> expected;
+        for (uint32_t i = 0; i < 32; ++i)
+        {
+            f.conn->query("INSERT INTO test VALUES (" + std::to_string(i % 8) + ", " + std::to_string(i) + ")");
+            expected[i % 8].push_back(i);
+        }
+        // Moves rows to another key, so to another worker
+        f.conn->query("UPDATE test SET id = id + 8, value = value + 100 WHERE id = 0");
+        for (uint32_t i : {0, 8, 16, 24})
+            expected[8].push_back(i + 100);
+        f.conn->query("INSERT INTO test VALUES (8, 1000)");
+        expected[8].push_back(1000);
+        f.waitCall();
+        f.m_Callback.setCallback();
+
+        BOOST_CHECK(values == expected);
+        BOOST_CHECK(threads.size() > 1);
+        BOOST_CHECK(threads.count(f.m_SlaveThread.get_id()) == 0);
+    }
+
+    void test_KeyColumnsBatch()
+    {
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.enableWorkers(4, 4);
+        f.m_Slave.setKeyColumns(f.cfg.mysql_db, "test", {0});
+        std::mutex mutex;
+        std::vector<std::pair<uint32_t, uint32_t>> updates;
+        f.m_Slave.setBatchCallback(f.cfg.mysql_db, "test", [&](slave::RecordSetBatch& batch)
+        {
+            // Gives other workers the chance to overtake
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& rs : batch)
+                if (rs.type_event == slave::RecordSet::Update)
+                    updates.emplace_back(slave::get<uint32_t>(rs.m_old_row.at("id").second),
+                                         slave::get<uint32_t>(rs.m_row.at("id").second));
+        });
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (id int PRIMARY KEY, value int)");
+        f.startSlave();
+
+        f.conn->query("INSERT INTO test VALUES (1, 1), (2, 2), (3, 3), (4, 4), (5, 5), (6, 6), (7, 7), (8, 8)");
+        // One event, every row takes the key, which the previous one has left
+        f.conn->query("UPDATE test SET id = id + 1 ORDER BY id DESC");
+        f.waitCall();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::pair<uint32_t, uint32_t>> expected;
+        for (uint32_t id = 8; id > 0; --id)
+            expected.emplace_back(id, id + 1);
+        BOOST_CHECK(updates == expected);
+    }
+
+    void test_KeyColumnsMinimal()
+    {
+        // Rows without key columns in the image are ordered against all others
+        {
+            slave::Table table("db", "t");
+            table.key_columns.assign(1, 1);
+            table.key_columns_count = 1;
+            std::mutex mutex;
+            std::vector<unsigned> order;
+            table.m_callback = [&](slave::RecordSet& rs)
+            {
+                // Rows with odd keys are slow, so they are overtaken, if they may be
+                std::this_thread::sleep_for(std::chrono::milliseconds(rs.master_id % 2 ? 5 : 0));
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(rs.master_id);
+            };
+            slave::WorkerPool pool(4, 4);
+            for (unsigned i = 0; i < 12; ++i) {
+                slave::RecordSet rs;
+                rs.master_id = i;
+                rs.key_hash = i;
+                rs.key_unknown = i % 4 == 2;
+                pool.push(table, rs);
+            }
+            pool.drain();
+            // Only rows between the unknown ones (2, 6, 10) may be reordered
+            const auto segment = [](unsigned i) { return (i + 2) / 4 + (i + 1) / 4; };
+            BOOST_REQUIRE_EQUAL(order.size(), 12);
+            for (unsigned i = 0; i < order.size(); ++i)
+                BOOST_CHECK_EQUAL(segment(order[i]), segment(i));
+        }
+
+        Fixture f;
+        f.stopSlave();
+        f.m_Slave.enableWorkers(4, 4);
+        f.m_Slave.setKeyColumns(f.cfg.mysql_db, "test", {1});
+        f.conn->query("DROP TABLE IF EXISTS test");
+        f.conn->query("CREATE TABLE test (id int PRIMARY KEY, k int, value int)");
+        f.startSlave();
+
+        std::mutex mutex;
+        std::vector<std::pair<slave::RecordSet::TypeEvent, bool>> rows;
+        f.m_Callback.setCallback([&](slave::RecordSet& rs)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rows.emplace_back(rs.type_event, rs.key_unknown);
+        });
+
+        f.conn->query("SET binlog_row_image = MINIMAL");
+        f.conn->query("INSERT INTO test VALUES (1, 10, 1), (2, 20, 2)");
+        // Before image has only the primary key, after image - only the changed column
+        f.conn->query("UPDATE test SET value = 3 WHERE id = 1");
+        f.conn->query("UPDATE test SET k = 30 WHERE id = 2");
+        f.conn->query("DELETE FROM test WHERE id = 1");
+        f.waitCall();
+        f.m_Callback.setCallback();
+        f.conn->query("SET binlog_row_image = FULL");
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::vector<std::pair<slave::RecordSet::TypeEvent, bool>> expected = {
+            {slave::RecordSet::Write, false}, {slave::RecordSet::Write, false},
+            {slave::RecordSet::Update, true}, {slave::RecordSet::Update, false},
+            {slave::RecordSet::Delete, true}};
+        BOOST_CHECK(rows == expected);
+    }
+
     void test_GtidParsing()
     {
         slave::Position pos;
@@ -1712,6 +2672,102 @@ namespace // anonymous
         BOOST_CHECK_EQUAL(ref2.size(), 1);
         BOOST_CHECK(ref2.front() == slave::gtid_interval_t(2, 2));
     }
+
+    // Makes binlog file of events with given types, body of each event is its number
+    std::string makeBinlog(const std::vector<uint8_t>& types, bool truncated = false)
+    {
+        std::string data("\xfe\x62\x69\x6e", 4);
+        for (size_t i = 0; i < types.size(); ++i)
+        {
+            std::string body;
+            if (types[i] == slave::FORMAT_DESCRIPTION_EVENT)
+            {
+                body.assign(2 + ST_SERVER_VER_LEN, '\0');
+                body[0] = 4;
+                body.replace(2, 6, "5.7.20");
+            }
+            body += std::to_string(i);
+
+            const uint32_t len = LOG_EVENT_HEADER_LEN + body.size();
+            const uint32_t log_pos = data.size() + len;
+            std::string header(LOG_EVENT_HEADER_LEN, '\0');
+            header[EVENT_TYPE_OFFSET] = types[i];
+            ::memcpy(&header[EVENT_LEN_OFFSET], &len, 4);
+            ::memcpy(&header[LOG_POS_OFFSET], &log_pos, 4);
+            data += header + body;
+        }
+        if (truncated)
+            data.resize(data.size() - 1);
+        return data;
+    }
+
+    void writeBinlogFile(const std::string& path, const std::vector<uint8_t>& types, bool truncated = false)
+    {
+        std::ofstream(path, std::ios::binary) << makeBinlog(types, truncated);
+    }
+
+    void test_BinlogFileSource()
+    {
+        const std::string dir = "/tmp/libslave_test_binlog";
+        ::mkdir(dir.c_str(), 0755);
+        BOOST_CHECK_EQUAL(slave::BinlogFileSource::nextFileName(dir + "/mysql-bin.000009"), dir + "/mysql-bin.000010");
+        BOOST_CHECK_EQUAL(slave::BinlogFileSource::nextFileName("mysql-bin.99"), "mysql-bin.100");
+
+        writeBinlogFile(dir + "/mysql-bin.000009", {slave::FORMAT_DESCRIPTION_EVENT, slave::QUERY_EVENT, slave::XID_EVENT, slave::ROTATE_EVENT});
+        writeBinlogFile(dir + "/mysql-bin.000010", {slave::FORMAT_DESCRIPTION_EVENT, slave::QUERY_EVENT}, true);
+        ::unlink((dir + "/mysql-bin.000011").c_str());
+
+        std::vector<std::pair<std::string, int>> events;
+        const char* buf;
+        unsigned long len;
+
+        slave::BinlogFileSource source(dir + "/mysql-bin.000009");
+        BOOST_CHECK_EQUAL(source.serverVersion(), 50720);
+        BOOST_CHECK_EQUAL(source.position().log_name, "mysql-bin.000009");
+        BOOST_CHECK_EQUAL(source.position().log_pos, 4);
+        while (source.next(buf, len))
+            events.emplace_back(source.logName(), buf[EVENT_TYPE_OFFSET]);
+
+        // Incomplete event in the end of the last file is left for later
+        const std::vector<std::pair<std::string, int>> expected = {
+            {"mysql-bin.000009", slave::FORMAT_DESCRIPTION_EVENT},
+            {"mysql-bin.000009", slave::QUERY_EVENT},
+            {"mysql-bin.000009", slave::XID_EVENT},
+            {"mysql-bin.000009", slave::ROTATE_EVENT},
+            {"mysql-bin.000010", slave::FORMAT_DESCRIPTION_EVENT}};
+        BOOST_CHECK(events == expected);
+
+        // Format description is returned first from any position
+        const unsigned long query_len = LOG_EVENT_HEADER_LEN + 1;
+        slave::BinlogFileSource from_xid(dir + "/mysql-bin.000009", 4 + LOG_EVENT_HEADER_LEN + 2 + ST_SERVER_VER_LEN + 1 + query_len, false);
+        events.clear();
+        while (from_xid.next(buf, len))
+            events.emplace_back(from_xid.logName(), buf[EVENT_TYPE_OFFSET]);
+        BOOST_CHECK_EQUAL(events.size(), 3);
+        BOOST_CHECK_EQUAL(events[0].second, slave::FORMAT_DESCRIPTION_EVENT);
+        BOOST_CHECK_EQUAL(events[1].second, slave::XID_EVENT);
+    }
+
+    void test_MemoryEventSource()
+    {
+        const std::string data = makeBinlog({slave::FORMAT_DESCRIPTION_EVENT, slave::QUERY_EVENT, slave::XID_EVENT}, true);
+        slave::MemoryEventSource source(data.data(), data.size());
+        BOOST_CHECK_EQUAL(source.serverVersion(), 50720);
+
+        const char* buf;
+        unsigned long len;
+        for (int lap = 0; lap < 2; ++lap)
+        {
+            std::vector<int> types;
+            while (source.next(buf, len))
+            {
+                BOOST_CHECK(buf >= data.data() && buf + len <= data.data() + data.size());
+                types.push_back(buf[EVENT_TYPE_OFFSET]);
+            }
+            BOOST_CHECK(types == std::vector<int>({slave::FORMAT_DESCRIPTION_EVENT, slave::QUERY_EVENT}));
+            source.rewind();
+        }
+    }
 }// anonymous-namespace
 
 test_suite* init_unit_test_suite(int argc, char* argv[])
@@ -1727,8 +2783,34 @@ test_suite* init_unit_test_suite(int argc, char* argv[])
     ADD_FIXTURE_TEST(test_BinlogRowImageOption);
     ADD_FIXTURE_TEST(test_InsertNullValue);
     ADD_FIXTURE_TEST(test_AlterCreateTable);
+    ADD_FIXTURE_TEST(test_RowView);
+    ADD_FIXTURE_TEST(test_TypedTemporal);
+    ADD_FIXTURE_TEST(test_TimeZone);
+    ADD_FIXTURE_TEST(test_TypedDecimal);
+    ADD_FIXTURE_TEST(test_DecodePlan);
+    ADD_FIXTURE_TEST(test_PresentColumns);
+    ADD_FIXTURE_TEST(test_TableIdCache);
+    ADD_FIXTURE_TEST(test_SkipRowEvent);
+    ADD_FIXTURE_TEST(test_RawEventFilter);
+    ADD_FIXTURE_TEST(test_TransactionPayload);
+    ADD_FIXTURE_TEST(test_SocketReceivedBytes);
+    ADD_FIXTURE_TEST(test_CompressionOptions);
+    ADD_FIXTURE_TEST(test_Crc32);
+    ADD_FIXTURE_TEST(test_FieldValue);
+    ADD_FIXTURE_TEST(test_ZeroCopyStrings);
+    ADD_FIXTURE_TEST(test_Schema);
+    ADD_FIXTURE_TEST(test_BatchCallback);
+    ADD_FIXTURE_TEST(test_ReuseRecordSets);
+    ADD_FIXTURE_TEST(test_TransactionCallback);
+    ADD_FIXTURE_TEST(test_Pipeline);
+    ADD_FIXTURE_TEST(test_Workers);
+    ADD_FIXTURE_TEST(test_KeyColumns);
+    ADD_FIXTURE_TEST(test_KeyColumnsBatch);
+    ADD_FIXTURE_TEST(test_KeyColumnsMinimal);
     ADD_FIXTURE_TEST(test_GtidParsing);
     ADD_FIXTURE_TEST(test_GtidAdding);
+    ADD_FIXTURE_TEST(test_BinlogFileSource);
+    ADD_FIXTURE_TEST(test_MemoryEventSource);
 
 #undef ADD_FIXTURE_TEST
 
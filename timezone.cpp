@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "temporal.h"
+#include "timezone.h"
+
+namespace
+{
+
+const int64_t min_time = std::numeric_limits<int64_t>::min();
+const int64_t max_time = std::numeric_limits<int64_t>::max();
+
+// Transitions of the POSIX rule are put into the table up to this year,
+// the last offset is used after it
+const int last_rule_year = 2400;
+
+bool read_file(const std::string& path, std::string& data)
+{
+    std::ifstream f(path.c_str(), std::ios::binary);
+    if (!f)
+        return false;
+    std::ostringstream s;
+    s << f.rdbuf();
+    data = s.str();
+    return true;
+}
+
+int64_t big_endian(const char* p, unsigned bytes)
+{
+    uint64_t value = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+        value = (value << 8) | (unsigned char)p[i];
+    // sign extension
+    if (bytes < 8 && (value >> (8 * bytes - 1)))
+        value |= ~uint64_t(0) << (8 * bytes);
+    return int64_t(value);
+}
+
+// POSIX TZ string, see tzset(3): std offset [dst [offset] [,start[/time],end[/time]]]
+struct PosixRule
+{
+    struct Date
+    {
+        char kind = 'M';    // 'J' - Julian day without Feb 29, 'D' - zero-based day, 'M' - Mm.w.d
+        int day = 0;
+        int week = 0;
+        int month = 0;
+        int32_t time = 7200;
+    };
+
+    int32_t std_offset = 0;
+    int32_t dst_offset = 0;
+    bool has_dst = false;
+    Date start, end;
+
+    explicit PosixRule(const std::string& spec)
+    {
+        const char* p = spec.c_str();
+        if (!name(p))
+            throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+        // POSIX offsets are positive to the west
+        std_offset = -offset(p, spec);
+        if (!*p)
+            return;
+        if (!name(p))
+            throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+        has_dst = true;
+        dst_offset = std_offset + 3600;
+        if (*p && *p != ',')
+            dst_offset = -offset(p, spec);
+        if (!*p) {
+            // Default US rule, as glibc does
+            start.month = 3; start.week = 2;
+            end.month = 11; end.week = 1;
+            return;
+        }
+        if (*p++ != ',')
+            throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+        date(p, start, spec);
+        if (*p++ != ',')
+            throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+        date(p, end, spec);
+        if (*p)
+            throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+    }
+
+    static bool name(const char*& p)
+    {
+        const char* begin = p;
+        if (*p == '<') {
+            while (*p && *p != '>')
+                ++p;
+            if (!*p)
+                return false;
+            ++p;
+            return true;
+        }
+        while (std::isalpha((unsigned char)*p))
+            ++p;
+        return p - begin >= 3;
+    }
+
+    static int number(const char*& p, const std::string& spec)
+    {
+        if (!std::isdigit((unsigned char)*p))
+            throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+        int value = 0;
+        while (std::isdigit((unsigned char)*p))
+            value = value * 10 + (*p++ - '0');
+        return value;
+    }
+
+    // [+|-]hh[:mm[:ss]]
+    static int32_t offset(const char*& p, const std::string& spec)
+    {
+        int sign = 1;
+        if (*p == '+' || *p == '-')
+            sign = *p++ == '-' ? -1 : 1;
+        int32_t value = number(p, spec) * 3600;
+        if (*p == ':') {
+            ++p;
+            value += number(p, spec) * 60;
+            if (*p == ':') {
+                ++p;
+                value += number(p, spec);
+            }
+        }
+        return sign * value;
+    }
+
+    static void date(const char*& p, Date& d, const std::string& spec)
+    {
+        if (*p == 'M') {
+            ++p;
+            d.kind = 'M';
+            d.month = number(p, spec);
+            if (*p++ != '.')
+                throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+            d.week = number(p, spec);
+            if (*p++ != '.')
+                throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+            d.day = number(p, spec);
+            if (d.month < 1 || d.month > 12 || d.week < 1 || d.week > 5 || d.day > 6)
+                throw std::runtime_error("TimeZone: unknown zone or bad TZ string '" + spec + "'");
+        } else if (*p == 'J') {
+            ++p;
+            d.kind = 'J';
+            d.day = number(p, spec);
+        } else {
+            d.kind = 'D';
+            d.day = number(p, spec);
+        }
+        if (*p == '/') {
+            ++p;
+            // may be negative or greater than 24 hours
+            d.time = offset(p, spec);
+        }
+    }
+
+    static bool is_leap(int year)
+    {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    // Local seconds since the epoch of the transition in the year
+    static int64_t local_time(const Date& d, int year)
+    {
+        int32_t days;
+        if (d.kind == 'J') {
+            days = slave::days_from_civil(year, 1, 1) + d.day - 1 + (is_leap(year) && d.day >= 60 ? 1 : 0);
+        } else if (d.kind == 'D') {
+            days = slave::days_from_civil(year, 1, 1) + d.day;
+        } else {
+            static const int month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+            const int32_t first = slave::days_from_civil(year, d.month, 1);
+            // 1970-01-01 was Thursday
+            const int first_wday = ((first + 4) % 7 + 7) % 7;
+            int day = (d.day - first_wday + 7) % 7 + (d.week - 1) * 7;
+            const int length = month_days[d.month - 1] + (d.month == 2 && is_leap(year) ? 1 : 0);
+            while (day >= length)
+                day -= 7;
+            days = first + day;
+        }
+        return int64_t(days) * 86400 + d.time;
+    }
+};
+
+}// anonymous-namespace
+
+namespace slave
+{
+
+std::shared_ptr<const TimeZone> TimeZone::load(const std::string& name)
+{
+    std::shared_ptr<TimeZone> tz(new TimeZone());
+
+    std::string spec = name;
+    if (spec.empty()) {
+        // see tzset(3)
+        const char* env = ::getenv("TZ");
+        spec = env ? (*env ? env : "UTC0") : "/etc/localtime";
+    }
+    if (spec[0] == ':')
+        spec.erase(0, 1);
+    tz->m_name = spec;
+
+    std::string path = spec;
+    if (!path.empty() && path[0] != '/') {
+        const char* dir = ::getenv("TZDIR");
+        path = std::string(dir && *dir ? dir : "/usr/share/zoneinfo") + "/" + spec;
+    }
+
+    std::string data;
+    if (read_file(path, data) && data.compare(0, 4, "TZif") == 0)
+        tz->loadTZif(data);
+    else
+        tz->loadPosix(spec);
+
+    return tz;
+}
+
+void TimeZone::loadTZif(const std::string& data)
+{
+    // see RFC 8536
+    const size_t header_size = 44;
+    struct Counts
+    {
+        int64_t isut, isstd, leap, time, type, chars;
+
+        explicit Counts(const char* p) :
+            isut(big_endian(p + 20, 4)), isstd(big_endian(p + 24, 4)), leap(big_endian(p + 28, 4)),
+            time(big_endian(p + 32, 4)), type(big_endian(p + 36, 4)), chars(big_endian(p + 40, 4))
+        {}
+
+        size_t size(unsigned time_size) const
+        {
+            return time * time_size + time + type * 6 + chars + leap * (time_size + 4) + isstd + isut;
+        }
+    };
+
+    if (data.size() < header_size)
+        throw std::runtime_error("TimeZone: truncated zone file '" + m_name + "'");
+
+    Counts counts(data.data());
+    size_t pos = header_size;
+    unsigned time_size = 4;
+
+    if (data[4] >= '2') {
+        // Skip version 1 data, version 2+ has 64-bit times and the POSIX rule in the footer
+        pos += counts.size(4);
+        if (data.size() < pos + header_size)
+            throw std::runtime_error("TimeZone: truncated zone file '" + m_name + "'");
+        counts = Counts(data.data() + pos);
+        pos += header_size;
+        time_size = 8;
+    }
+    if (data.size() < pos + counts.size(time_size) || counts.type == 0)
+        throw std::runtime_error("TimeZone: truncated zone file '" + m_name + "'");
+    if (counts.leap)
+        throw std::runtime_error("TimeZone: zone file with leap seconds '" + m_name + "' is not supported");
+
+    const char* times = data.data() + pos;
+    const char* indexes = times + counts.time * time_size;
+    const char* types = indexes + counts.time;
+
+    auto type_offset = [&](unsigned i) { return int32_t(big_endian(types + i * 6, 4)); };
+    auto type_dst = [&](unsigned i) { return types[i * 6 + 4] != 0; };
+
+    m_initial_offset = type_offset(0);
+    m_initial_dst = type_dst(0);
+    for (int64_t i = 0; i < counts.time; ++i) {
+        const unsigned type = (unsigned char)indexes[i];
+        if (type >= counts.type)
+            throw std::runtime_error("TimeZone: bad zone file '" + m_name + "'");
+        m_transitions.push_back(big_endian(times + i * time_size, time_size));
+        m_offsets.push_back(type_offset(type));
+        m_dst.push_back(type_dst(type));
+    }
+
+    // Footer: "\n<POSIX TZ string>\n", is used after the last transition
+    pos += counts.size(time_size);
+    if (time_size == 8 && pos < data.size() && data[pos] == '\n') {
+        const size_t end = data.find('\n', pos + 1);
+        if (end != std::string::npos && end > pos + 1)
+            loadPosix(data.substr(pos + 1, end - pos - 1));
+    }
+}
+
+void TimeZone::loadPosix(const std::string& spec)
+{
+    const PosixRule rule(spec);
+    const bool empty = m_transitions.empty();
+
+    if (!rule.has_dst) {
+        if (empty) {
+            m_initial_offset = rule.std_offset;
+            m_initial_dst = false;
+        } else if (m_offsets.back() != rule.std_offset || m_dst.back()) {
+            m_transitions.push_back(m_transitions.back() + 1);
+            m_offsets.push_back(rule.std_offset);
+            m_dst.push_back(false);
+        }
+        return;
+    }
+
+    // The rule is in effect after the last transition of the zone file
+    int year = 1970;
+    if (!empty) {
+        unsigned month, day;
+        civil_from_days(int32_t(m_transitions.back() / 86400), year, month, day);
+    }
+
+    for (; year <= last_rule_year; ++year) {
+        // Start is given in standard time, end - in daylight saving time
+        std::pair<int64_t, bool> changes[] = {
+            {PosixRule::local_time(rule.start, year) - rule.std_offset, true},
+            {PosixRule::local_time(rule.end, year) - rule.dst_offset, false}
+        };
+        if (changes[1].first < changes[0].first)
+            std::swap(changes[0], changes[1]);
+        for (const auto& change : changes) {
+            if (!m_transitions.empty() && change.first <= m_transitions.back()) {
+                // The rule gives DST for the whole year (i.e. "EST5EDT,0/0,J365/25")
+                if (change.first == m_transitions.back()) {
+                    m_offsets.back() = change.second ? rule.dst_offset : rule.std_offset;
+                    m_dst.back() = change.second;
+                }
+                continue;
+            }
+            m_transitions.push_back(change.first);
+            m_offsets.push_back(change.second ? rule.dst_offset : rule.std_offset);
+            m_dst.push_back(change.second);
+        }
+    }
+
+    if (empty) {
+        // Before the first transition, i.e. DST of the southern hemisphere at the start of the year
+        m_initial_dst = !m_dst.front();
+        m_initial_offset = m_initial_dst ? rule.dst_offset : rule.std_offset;
+    }
+}
+
+TimeZone::Interval TimeZone::interval(int64_t t) const
+{
+    Interval result;
+    const size_t i = std::upper_bound(m_transitions.begin(), m_transitions.end(), t) - m_transitions.begin();
+    result.begin = i ? m_transitions[i - 1] : min_time;
+    result.end = i < m_transitions.size() ? m_transitions[i] : max_time;
+    result.offset = i ? m_offsets[i - 1] : m_initial_offset;
+    result.is_dst = i ? m_dst[i - 1] : m_initial_dst;
+    return result;
+}
+
+void TimeZone::localtime(int64_t t, struct ::tm& tm, Interval& cache) const
+{
+    if (!cache.contains(t))
+        cache = interval(t);
+
+    const int64_t local = t + cache.offset;
+    int64_t days = local / 86400;
+    int64_t seconds = local % 86400;
+    if (seconds < 0) {
+        seconds += 86400;
+        --days;
+    }
+
+    int year;
+    unsigned month, day;
+    civil_from_days(int32_t(days), year, month, day);
+
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = seconds / 3600;
+    tm.tm_min = seconds / 60 % 60;
+    tm.tm_sec = seconds % 60;
+    tm.tm_isdst = cache.is_dst;
+}
+
+}// slave
@@ -0,0 +1,64 @@
+#ifndef __SLAVE_TIMEZONE_H_
+#define __SLAVE_TIMEZONE_H_
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace slave
+{
+
+// Converts UTC seconds to local time without localtime_r(), which takes the global lock of libc
+// on every call. The zone is loaded once from the zoneinfo database (or a POSIX TZ string), its
+// transitions, including ones given by the POSIX rule for the future, are kept in a sorted table,
+// which is never changed after loading, so one TimeZone can be used by many threads.
+class TimeZone
+{
+public:
+    // Period of time with the same UTC offset, [begin, end)
+    struct Interval
+    {
+        int64_t begin = 0;
+        int64_t end = 0;
+        int32_t offset = 0;
+        bool    is_dst = false;
+
+        bool contains(int64_t t) const { return t >= begin && t < end; }
+    };
+
+    // Loads the zone by name: "Europe/Moscow" (from $TZDIR or /usr/share/zoneinfo), a file path,
+    // or a POSIX TZ string ("MSK-3"). Empty name is the zone of localtime_r(): $TZ or /etc/localtime.
+    // Throws std::runtime_error if the zone can not be loaded.
+    static std::shared_ptr<const TimeZone> load(const std::string& name = "");
+
+    const std::string& name() const { return m_name; }
+
+    // Binary search in the transitions table
+    Interval interval(int64_t t) const;
+
+    // Fills tm_year, tm_mon, tm_mday, tm_hour, tm_min, tm_sec and tm_isdst as localtime_r() does.
+    // Looks up the transitions table only if t is out of the cached interval, so the cache should be
+    // kept by the caller, one per thread (i.e. in the field, which is unpacked by one thread).
+    void localtime(int64_t t, struct ::tm& tm, Interval& cache) const;
+
+private:
+    TimeZone() {}
+
+    void loadTZif(const std::string& data);
+    void loadPosix(const std::string& spec);
+
+    std::string m_name;
+    // m_offsets[i] and m_dst[i] are in effect from m_transitions[i] to the next transition
+    std::vector<int64_t> m_transitions;
+    std::vector<int32_t> m_offsets;
+    std::vector<bool> m_dst;
+    int32_t m_initial_offset = 0;
+    bool m_initial_dst = false;
+};
+
+}// slave
+
+#endif
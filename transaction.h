@@ -0,0 +1,61 @@
+#ifndef __SLAVE_TRANSACTION_H_
+#define __SLAVE_TRANSACTION_H_
+
+#include <functional>
+#include <utility>
+
+#include "binlog_pos.h"
+#include "recordset.h"
+#include "table.h"
+
+namespace slave
+{
+
+// All rows of one committed transaction, see Slave::setTransactionCallback().
+struct Transaction
+{
+    gtid_t         gtid;            // empty if there was no GTID event
+    time_t         when = 0;        // commit time, from XID (or COMMIT) event
+    Position       position;        // position right after the transaction
+    unsigned int   master_id = 0;
+    RecordSetBatch rows;            // in binlog order, for all subscribed tables
+};
+
+typedef std::function<void (Transaction&)> transaction_callback;
+
+// Collects rows from BEGIN until commit.
+class TransactionBuffer : public RecordSink
+{
+public:
+    void push(const Table& table, RecordSet& rs) override
+    {
+        m_trx.rows.emplace_back(std::move(rs));
+    }
+
+    void begin()
+    {
+        m_trx.rows.clear();
+        m_started = true;
+    }
+
+    // Rows are kept until the next begin() to be handed to the callback
+    void finish() { m_started = false; }
+
+    void clear()
+    {
+        m_trx.rows.clear();
+        m_started = false;
+    }
+
+    bool started() const { return m_started; }
+
+    Transaction& transaction() { return m_trx; }
+
+private:
+    Transaction m_trx;
+    bool        m_started = false;
+};
+
+}// slave
+
+#endif
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <my_byteorder.h>
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "transaction_payload.h"
+
+namespace
+{
+
+// Gives out complete events of buf[begin, end), returns the beginning of the incomplete one
+size_t give_events(char* buf, size_t begin, size_t end, const slave::PayloadReader::event_callback& callback)
+{
+    while (end - begin >= LOG_EVENT_HEADER_LEN) {
+        const size_t len = uint4korr(buf + begin + EVENT_LEN_OFFSET);
+        if (len < LOG_EVENT_HEADER_LEN)
+            throw std::runtime_error("PayloadReader::unpack(): bad length of event " + std::to_string(len));
+        if (end - begin < len)
+            break;
+        callback(buf + begin, len);
+        begin += len;
+    }
+    return begin;
+}
+
+// Decompressed payload must have the size, which the event declares, if it does
+void check_size(const slave::Transaction_payload_event_info& tpi, uint64_t size)
+{
+    if (tpi.m_uncompressed_size && size != tpi.m_uncompressed_size)
+        throw std::runtime_error("PayloadReader::unpack(): payload is " + std::to_string(size) + " bytes uncompressed, "
+                                 + std::to_string(tpi.m_uncompressed_size) + " declared");
+}
+
+}// anonymous-namespace
+
+namespace slave
+{
+
+PayloadReader::~PayloadReader()
+{
+#ifdef WITH_ZSTD
+    ZSTD_freeDStream(m_stream);
+#endif
+}
+
+void PayloadReader::unpack(const Transaction_payload_event_info& tpi, const event_callback& callback, std::vector<char>* keep)
+{
+    std::vector<char>& buffer = keep ? *keep : m_buffer;
+
+    if (tpi.m_compression == Transaction_payload_event_info::None) {
+        check_size(tpi, tpi.m_payload_size);
+        buffer.resize(tpi.m_payload_size);
+        ::memcpy(buffer.data(), tpi.m_payload, tpi.m_payload_size);
+        if (give_events(buffer.data(), 0, buffer.size(), callback) != buffer.size())
+            throw std::runtime_error("PayloadReader::unpack(): payload ends inside of an event");
+        return;
+    }
+
+    if (tpi.m_compression != Transaction_payload_event_info::Zstd)
+        throw std::runtime_error("PayloadReader::unpack(): unknown compression type " + std::to_string(tpi.m_compression));
+
+#ifndef WITH_ZSTD
+    throw std::runtime_error("PayloadReader::unpack(): libslave is built without zstd, compressed transactions can not be read");
+#else
+    if (!m_stream) {
+        m_stream = ZSTD_createDStream();
+        if (!m_stream)
+            throw std::runtime_error("PayloadReader::unpack(): ZSTD_createDStream() failed");
+    }
+    else
+        ZSTD_DCtx_reset(m_stream, ZSTD_reset_session_only);
+
+    // The buffer grows with the decompressed data: the declared size is only a hint, which comes
+    // from the event and is not trusted
+    static const size_t chunk = ZSTD_DStreamOutSize();
+    static const uint64_t max_reserve = 64 << 20;
+    if (keep)
+        buffer.reserve(std::min(tpi.m_uncompressed_size, max_reserve) + chunk);
+
+    ZSTD_inBuffer in = {tpi.m_payload, size_t(tpi.m_payload_size), 0};
+    // Decompressed events, which are not given out yet, are buffer[begin, end)
+    size_t begin = 0, end = 0;
+    uint64_t total = 0;
+    size_t ret = 1;
+
+    while (ret != 0 || in.pos < in.size) {
+        if (!keep) {
+            begin = give_events(buffer.data(), begin, end, callback);
+            // Move the incomplete event to the front
+            ::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (buffer.size() < end + chunk)
+            buffer.resize(end + chunk);
+
+        ZSTD_outBuffer out = {buffer.data(), buffer.size(), end};
+        ret = ZSTD_decompressStream(m_stream, &out, &in);
+        if (ZSTD_isError(ret))
+            throw std::runtime_error(std::string("PayloadReader::unpack(): ZSTD_decompressStream() failed: ") + ZSTD_getErrorName(ret));
+        // Input is over, but the frame is not, and the output had room
+        if (ret != 0 && in.pos == in.size && out.pos < out.size)
+            throw std::runtime_error("PayloadReader::unpack(): compressed payload is truncated");
+        total += out.pos - end;
+        end = out.pos;
+        if (tpi.m_uncompressed_size && total > tpi.m_uncompressed_size)
+            check_size(tpi, total);
+    }
+    check_size(tpi, total);
+
+    if (give_events(buffer.data(), begin, end, callback) != end)
+        throw std::runtime_error("PayloadReader::unpack(): payload ends inside of an event");
+#endif
+}
+
+}// slave
@@ -0,0 +1,43 @@
+#ifndef __SLAVE_TRANSACTION_PAYLOAD_H_
+#define __SLAVE_TRANSACTION_PAYLOAD_H_
+
+#include <functional>
+#include <vector>
+
+#include "slave_log_event.h"
+
+struct ZSTD_DCtx_s;
+
+namespace slave
+{
+
+// Unpacks events of TRANSACTION_PAYLOAD_EVENT. The payload is decompressed by chunks into
+// a buffer, which is reused from event to event, and every event is given out as soon as it is
+// complete, so the buffer keeps the largest event and a chunk, not the whole transaction.
+// Events have no checksum; they may be changed in place.
+class PayloadReader
+{
+public:
+    typedef std::function<void (char* buf, unsigned long len)> event_callback;
+
+    PayloadReader() {}
+    ~PayloadReader();
+
+    PayloadReader(const PayloadReader&) = delete;
+    PayloadReader& operator=(const PayloadReader&) = delete;
+
+    // If keep is given, the whole payload is decompressed into it before the first event is given
+    // out, so the events live as long as it is not changed (i.e. rows of the pipeline refer to them).
+    // Throws on unknown compression, broken payload or payload, which decompresses to other size,
+    // than the event declares, and, if libslave is built without zstd, on compressed payload.
+    // Without keep, events before the error may be given out already.
+    void unpack(const Transaction_payload_event_info& tpi, const event_callback& callback, std::vector<char>* keep = nullptr);
+
+private:
+    ZSTD_DCtx_s* m_stream = nullptr;
+    std::vector<char> m_buffer;
+};
+
+}// slave
+
+#endif
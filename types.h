@@ -5,18 +5,13 @@
 #include <string>
 #include <time.h>
 
+#include "field_value.h"
+
 // conflict with macro defined in mysql
 #ifdef test
 #undef test
 #endif /* test */
 
-#ifdef SLAVE_USE_VARIANT_FOR_FIELD_VALUE
-#include <cstddef>              // for std::nullptr_t
-#include <boost/variant.hpp>
-#else
-#include <boost/any.hpp>
-#endif
-
 namespace slave {
 namespace types
 {
@@ -92,33 +87,10 @@ namespace types
 
 enum class RowType {
     Map,
-    Vector
+    Vector,
+    View
 };
 
-#ifdef SLAVE_USE_VARIANT_FOR_FIELD_VALUE
-    using FieldValue = boost::variant<std::nullptr_t
-                                    , int
-                                    , char
-                                    , uint16_t
-                                    , int32_t
-                                    , uint32_t
-                                    , unsigned long long
-                                    , float
-                                    , double
-                                    , std::string
-                                    >;
-    inline std::nullptr_t nullFieldValue() { return nullptr; }
-    inline bool isNullFieldValue(const FieldValue& v) { return v.type() == typeid(std::nullptr_t); }
-    template <typename T>
-    const T& get(const FieldValue& v) { return boost::get<T>(v); }
-#else
-    using FieldValue = boost::any;
-    inline boost::any nullFieldValue() { return boost::any(); }
-    inline bool isNullFieldValue(const FieldValue& v) { return v.empty(); }
-    template <typename T>
-    T get(const FieldValue& v) { return boost::any_cast<T>(v); }
-#endif
-
 }// slave
 
 #endif
@@ -0,0 +1,261 @@
+#ifndef __SLAVE_WORKERS_H_
+#define __SLAVE_WORKERS_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Logging.h"
+#include "binlog_pos.h"
+#include "pipeline.h"
+#include "recordset.h"
+#include "table.h"
+
+namespace slave
+{
+
+// Position update (or other commit action), which must wait until all rows before it are applied.
+// Is put into queues of workers, which have got rows since the previous marker. Markers are
+// committed strictly in order (low-watermark): action of a marker is run once all workers
+// have got it and all previous markers are committed.
+struct CommitMarker
+{
+    // Number of workers yet to get the marker, plus one until it is committed. 0 means free.
+    std::atomic<unsigned>  pending {0};
+    std::function<void ()> action;
+    Position               position;
+    unsigned int           server_id = 0;
+};
+
+struct WorkerTask
+{
+    enum Kind { Row, Batch, Marker, Stop };
+
+    Kind           kind = Row;
+    const Table*   table = nullptr;
+    RecordSet      rs;
+    RecordSetBatch batch;
+    CommitMarker*  marker = nullptr;
+};
+
+// Calls table callbacks in a pool of threads, see Slave::enableWorkers().
+// Rows of a table go to the same worker (Table::m_worker), so they stay in order.
+// If the table has key columns, rows are spread over workers by hash of the key,
+// and stay in order for every key.
+class WorkerPool : public RecordSink
+{
+public:
+    WorkerPool(size_t workers, size_t queue_size)
+        : m_markers(workers * queue_size)
+    {
+        for (size_t i = 0; i < workers; ++i) {
+            m_workers.emplace_back(new Worker(*this, queue_size));
+            Worker* w = m_workers.back().get();
+            w->thread = std::thread([w] { w->run(); });
+        }
+    }
+
+    ~WorkerPool()
+    {
+        for (auto& w : m_workers) {
+            w->ring.acquire(0).kind = WorkerTask::Stop;
+            w->ring.release(0);
+        }
+        for (auto& w : m_workers)
+            w->thread.join();
+    }
+
+    size_t size() const { return m_workers.size(); }
+
+    void push(const Table& table, RecordSet& rs) override
+    {
+        // Previous rows with the old key may be in any other worker
+        const bool key_unknown = rs.key_unknown;
+        if (rs.key_changed || key_unknown)
+            drain();
+
+        Worker& w = *m_workers[route(table, rs)];
+        WorkerTask& task = w.ring.acquire(0);
+        task.kind = WorkerTask::Row;
+        task.table = &table;
+        task.rs = std::move(rs);
+        w.ring.release(0);
+        w.dirty = true;
+
+        // Next rows may have the key of this one, which is not known
+        if (key_unknown)
+            drain();
+    }
+
+    void pushBatch(const Table& table, RecordSetBatch& batch) override
+    {
+        if (table.key_columns.empty()) {
+            pushBatch(*m_workers[route(table, batch.front())], table, batch);
+            return;
+        }
+
+        // The batch is split at rows, which change the key: rows before them, with the old key,
+        // may be in any worker, including the rows of this batch, so they are pushed and drained first.
+        // Rows with unknown key are pushed alone and drained, as in push().
+        size_t begin = 0;
+        while (begin < batch.size()) {
+            const bool key_unknown = batch[begin].key_unknown;
+            if (batch[begin].key_changed || key_unknown)
+                drain();
+            size_t end = begin + 1;
+            while (!key_unknown && end < batch.size() && !batch[end].key_changed && !batch[end].key_unknown)
+                ++end;
+            pushParts(table, batch, begin, end);
+            if (key_unknown)
+                drain();
+            begin = end;
+        }
+    }
+
+    // Free marker to fill and pass to barrier()
+    CommitMarker& marker()
+    {
+        CommitMarker& m = m_markers[m_next_marker++ % m_markers.size()];
+        if (m.pending.load()) {
+            std::unique_lock<std::mutex> lock(m_commit_mutex);
+            m_commit_cond.wait(lock, [&m] { return m.pending.load() == 0; });
+        }
+        return m;
+    }
+
+    // Marker action will be run after all rows, pushed before, are applied
+    void barrier(CommitMarker& m)
+    {
+        unsigned dirty = 0;
+        for (auto& w : m_workers)
+            dirty += w->dirty;
+
+        m.pending = dirty + 1;
+        for (auto& w : m_workers) {
+            if (!w->dirty)
+                continue;
+            WorkerTask& task = w->ring.acquire(0);
+            task.kind = WorkerTask::Marker;
+            task.marker = &m;
+            w->ring.release(0);
+            w->dirty = false;
+        }
+
+        if (!dirty)
+            commit();
+    }
+
+    // Waits until all pushed tasks are done
+    void drain()
+    {
+        for (auto& w : m_workers)
+            w->ring.drain();
+    }
+
+private:
+    struct Worker
+    {
+        WorkerPool& pool;
+        Ring<WorkerTask, 2> ring;
+        std::thread thread;
+        // Has got rows since the last marker, used by the pushing thread only
+        bool dirty = false;
+
+        Worker(WorkerPool& _pool, size_t queue_size) : pool(_pool), ring(queue_size) {}
+
+        void run()
+        {
+            while (true) {
+                WorkerTask& task = ring.acquire(1);
+                const auto kind = task.kind;
+                try {
+                    if (kind == WorkerTask::Row)
+                        task.table->m_callback(task.rs);
+                    else if (kind == WorkerTask::Batch)
+                        task.table->m_batch_callback(task.batch);
+                }
+                catch (const std::exception& _ex) {
+                    LOG_ERROR(log, "Met exception in worker. Message: " << _ex.what() );
+                }
+                if (kind == WorkerTask::Marker && task.marker->pending.fetch_sub(1) == 2)
+                    pool.commit();
+                ring.release(1);
+                if (kind == WorkerTask::Stop)
+                    return;
+            }
+        }
+    };
+
+    unsigned route(const Table& table, const RecordSet& rs) const
+    {
+        if (table.key_columns.empty() || rs.key_unknown)
+            return table.m_worker % m_workers.size();
+        return rs.key_hash % m_workers.size();
+    }
+
+    void pushBatch(Worker& w, const Table& table, RecordSetBatch& batch)
+    {
+        WorkerTask& task = w.ring.acquire(0);
+        task.kind = WorkerTask::Batch;
+        task.table = &table;
+        task.batch.swap(batch);
+        w.ring.release(0);
+        w.dirty = true;
+    }
+
+    // Every worker gets its part of batch[begin, end)
+    void pushParts(const Table& table, RecordSetBatch& batch, size_t begin, size_t end)
+    {
+        m_routes.clear();
+        for (size_t j = begin; j < end; ++j)
+            m_routes.push_back(route(table, batch[j]));
+        for (size_t i = 0; i < m_workers.size(); ++i) {
+            m_part.clear();
+            for (size_t j = begin; j < end; ++j)
+                if (m_routes[j - begin] == i)
+                    m_part.emplace_back(std::move(batch[j]));
+            if (!m_part.empty())
+                pushBatch(*m_workers[i], table, m_part);
+        }
+    }
+
+    // Runs actions of all markers, got by all their workers, in order
+    void commit()
+    {
+        std::lock_guard<std::mutex> lock(m_commit_mutex);
+        while (true) {
+            CommitMarker& m = m_markers[m_committed % m_markers.size()];
+            if (m.pending.load() != 1)
+                break;
+            try {
+                m.action();
+            }
+            catch (const std::exception& _ex) {
+                LOG_ERROR(log, "Met exception in commit action. Message: " << _ex.what() );
+            }
+            m.pending = 0;
+            ++m_committed;
+        }
+        m_commit_cond.notify_all();
+    }
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::vector<CommitMarker> m_markers;
+    size_t m_next_marker = 0;
+    size_t m_committed = 0;
+    std::mutex m_commit_mutex;
+    std::condition_variable m_commit_cond;
+
+    // Scratch buffers for splitting batches
+    std::vector<unsigned> m_routes;
+    RecordSetBatch m_part;
+};
+
+}// slave
+
+#endif